@@ -0,0 +1,47 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/fft.hpp>
+#include <string>
+
+using namespace Eigen;
+using namespace disiple;
+
+namespace {
+
+    const char* name(FFTBackend backend)
+    {
+        switch (backend) {
+            case FFTBackend::Eigen:      return "eigen";
+            case FFTBackend::PFFFT:      return "pffft";
+            case FFTBackend::Accelerate: return "accelerate";
+            default:                     return "default";
+        }
+    }
+
+    void bench_backend(FFTBackend backend, size_t n)
+    {
+        if (!fft_backend_available(backend))
+            return;
+
+        const std::string suffix = std::string(name(backend)) + " " + std::to_string(n);
+
+        FFT fft(n, backend);
+        ArrayXf  x = ArrayXf::Random(n), xi(n);
+        ArrayXcf y(n/2+1);
+        ArrayXXf  xb = ArrayXXf::Random(32, n);
+        ArrayXXcf yb(32, n/2+1);
+
+        BENCHMARK("forward " + suffix) { fft(x, y); return y[0]; };
+        BENCHMARK("inverse " + suffix) { fft.inverse(y, xi); return xi[0]; };
+        BENCHMARK("batch 32 " + suffix) { fft.batch(xb, yb); return yb(0, 0); };
+    }
+
+}
+
+TEST_CASE("FFT backends", "[fft][!benchmark]")
+{
+    // fir_gain pads filter lengths to powers of two, spectral estimates
+    // use epochs such as 1 s or 4 s at 250 Hz
+    for (size_t n : { 64, 256, 1024, 4096, 250, 1000, 2000 })
+        for (FFTBackend b : { FFTBackend::Eigen, FFTBackend::PFFFT, FFTBackend::Accelerate })
+            bench_backend(b, n);
+}
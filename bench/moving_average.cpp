@@ -0,0 +1,30 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/moving_average.hpp>
+
+using namespace Eigen;
+using namespace disiple;
+
+namespace {
+
+    template <SummationMode Mode, int S>
+    void bench_mode(const char* name, const ArrayXXf& x)
+    {
+        MovingAverage<float, Stages<S>, Channels<Dynamic>, Summation<Mode>> f(2000);
+        ArrayXXf y(x.rows(), x.cols());
+        BENCHMARK(name) { f.apply(x, y); return y(0, 0); };
+    }
+
+}
+
+TEST_CASE("Moving average summation modes", "[moving_average][!benchmark]")
+{
+    // 1 s of 64 channels at 1 kHz
+    const ArrayXXf x = ArrayXXf::Random(64, 1000) + 1000;
+
+    bench_mode<Plain,       1>("plain, 1 stage",       x);
+    bench_mode<Resync,      1>("resync, 1 stage",      x);
+    bench_mode<Compensated, 1>("compensated, 1 stage", x);
+    bench_mode<Plain,       3>("plain, 3 stages",       x);
+    bench_mode<Resync,      3>("resync, 3 stages",      x);
+    bench_mode<Compensated, 3>("compensated, 3 stages", x);
+}
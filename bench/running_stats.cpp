@@ -0,0 +1,52 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/running_statistics.hpp>
+#include <string>
+
+using namespace Eigen;
+using namespace disiple;
+
+TEST_CASE("Running min, max and range", "[running_stats][!benchmark]")
+{
+    // 1 s of 64 channels at 1 kHz, a falling ramp is the worst case for
+    // the running minimum as every sample stays in its wedge
+    const ArrayXXf noise = ArrayXXf::Random(64, 1000);
+    const ArrayXXf ramp  = -RowVectorXf::LinSpaced(1000, 0, 999).array().replicate(64, 1);
+    ArrayXXf y(64, 1000);
+
+    for (int len : { 10, 1000 })
+    {
+        RunningMin  <float, Channels<Dynamic>> fmin(len);
+        RunningRange<float, Channels<Dynamic>> frng(len);
+        const std::string n = std::to_string(len);
+
+        BENCHMARK("min, noise, length " + n) { fmin.apply(noise, y); return y(0, 0); };
+        BENCHMARK("min, ramp, length " + n)  { fmin.apply(ramp, y);  return y(0, 0); };
+        BENCHMARK("range, noise, length " + n) { frng.apply(noise, y); return y(0, 0); };
+    }
+}
+
+TEST_CASE("Block running min and range", "[running_stats][!benchmark]")
+{
+    const ArrayXXf noise = ArrayXXf::Random(64, 1000);
+    ArrayXXf y(64, 1000);
+
+    for (int len : { 10, 1000 })
+    {
+        const std::string n = std::to_string(len);
+
+        BENCHMARK("block min, noise, length " + n)   { running_min(noise, len, y);   return y(0, 0); };
+        BENCHMARK("block range, noise, length " + n) { running_range(noise, len, y); return y(0, 0); };
+    }
+}
+
+TEST_CASE("Running median", "[running_stats][!benchmark]")
+{
+    const ArrayXXf noise = ArrayXXf::Random(64, 1000);
+    ArrayXXf y(64, 1000);
+
+    for (int len : { 11, 1001 })
+    {
+        RunningMedian<float, Channels<Dynamic>> f(len);
+        BENCHMARK("median, noise, length " + std::to_string(len)) { f.apply(noise, y); return y(0, 0); };
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <disiple/impl/filter_base.hpp>
+#include <disiple/impl/comb_impl.hpp>
+#include <disiple/named_params.hpp>
+
+namespace disiple {
+
+    /// Recursive comb filter, notching out the frequency 2/N (normalized
+    /// to Nyquist) and all of its harmonics with bandwidth BW:
+    ///     y[n] = g * (x[n] - x[n-N]) + r * y[n-N]
+    /// Same response as IIR(comb(N, BW)), but designed in closed form and
+    /// with a cost per sample that does not depend on N.
+    template <typename Scalar, typename... Options>
+    class Comb : public FilterBase<Scalar, Comb<Scalar, Options...>>,
+                 public Parameters<
+                        List<Options...>,
+                        OptionalValue<int, Length, Eigen::Dynamic>,
+                        OptionalValue<int, Channels, 1>
+                    >
+    {
+    public:
+        using State  = CombState<Scalar, Comb::length, Comb::channels>;
+        using Coeffs = CombCoeffs<Scalar, Comb::length>;
+
+        Comb() {}
+        Comb(int N, double BW) : coeffs_(N, BW) {}
+
+    private:
+        friend FilterBase<Scalar, Comb<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+}
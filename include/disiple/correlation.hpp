@@ -0,0 +1,132 @@
+#pragma once
+
+#include <disiple/fft.hpp>
+#include <Eigen/Core>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace disiple {
+
+    /// Scaling of correlations, as in MATLAB's xcorr
+    enum class CorrelationScaling
+    {
+        None,       ///< Raw sums of products
+        Biased,     ///< Divided by the length n
+        Unbiased,   ///< Divided by the number of overlapping samples, n-|lag|
+        Coefficient ///< Normalized to 1 at lag 0 for identical signals
+    };
+
+    /// Channels i and j of a channels-by-time block
+    using ChannelPair = std::pair<int, int>;
+
+    namespace internal {
+
+        struct CorrelationBuffers
+        {
+            Eigen::ArrayXXf  padded;
+            Eigen::ArrayXXcf spectra;
+            Eigen::ArrayXcf  product;
+            Eigen::ArrayXf   result;
+            Eigen::ArrayXf   energy;
+        };
+
+        // correlations of the given pairs of rows of x for lags
+        // -max_lag..max_lag, into the rows of r
+        void correlate(const Eigen::Ref<const Eigen::ArrayXXf>& x,
+                       const std::vector<ChannelPair>& pairs, int max_lag,
+                       CorrelationScaling scaling, CorrelationBuffers& buf,
+                       Eigen::Ref<Eigen::ArrayXXf> r);
+    }
+
+    /// Cross-correlation r[l] = sum_t x[t+l] y[t] of two signals of equal
+    /// length for lags l = -max_lag..max_lag, computed via the FFT.
+    /// @return Correlation, element k corresponds to lag k-max_lag
+    Eigen::ArrayXf xcorr(const Eigen::Ref<const Eigen::ArrayXf>& x,
+                         const Eigen::Ref<const Eigen::ArrayXf>& y, int max_lag,
+                         CorrelationScaling scaling = CorrelationScaling::None);
+
+    /// Cross-correlations of pairs of channels
+    /// @param x Input, channels-by-time
+    /// @return  pairs-by-(2*max_lag+1), column k corresponds to lag k-max_lag
+    Eigen::ArrayXXf xcorr(const Eigen::Ref<const Eigen::ArrayXXf>& x,
+                          const std::vector<ChannelPair>& pairs, int max_lag,
+                          CorrelationScaling scaling = CorrelationScaling::None);
+
+    /// Autocorrelations of all channels for lags 0..max_lag
+    /// @param x Input, channels-by-time
+    /// @return  channels-by-(max_lag+1)
+    Eigen::ArrayXXf autocorr(const Eigen::Ref<const Eigen::ArrayXXf>& x, int max_lag,
+                             CorrelationScaling scaling = CorrelationScaling::None);
+
+
+    /// Streaming cross-correlation of pairs of channels over a sliding
+    /// window: every hop samples (once window samples have arrived) the
+    /// correlations of the last window samples are computed, as by xcorr.
+    /// Use pairs (i, i) for autocorrelations.
+    class SlidingCorrelation
+    {
+    public:
+        SlidingCorrelation(int window, int max_lag, int hop,
+                           std::vector<ChannelPair> pairs,
+                           CorrelationScaling scaling = CorrelationScaling::None);
+
+        int window()    const { return window_; }
+        int max_lag()   const { return max_lag_; }
+        int hop()       const { return hop_; }
+        int num_pairs() const { return static_cast<int>(pairs_.size()); }
+
+        /// Discard all buffered input
+        void initialize();
+
+        /// Feed input and call f(r) for each completed window, where r is
+        /// a const Eigen::ArrayXXf&, pairs-by-(2*max_lag+1)
+        /// @param x Input array, channels-by-time
+        /// @return  Number of windows
+        template <typename X, typename F>
+        int apply(const Eigen::ArrayBase<X>& x, F&& f);
+
+    private:
+        void setup(int nchans);
+        void correlate_window();
+
+        int window_, max_lag_, hop_;
+        std::vector<ChannelPair> pairs_;
+        CorrelationScaling       scaling_;
+
+        Eigen::ArrayXXf  buf_;     // ring buffer, channels-by-window
+        Eigen::ArrayXXf  frame_;   // window in time order
+        Eigen::ArrayXXf  result_;
+        internal::CorrelationBuffers work_;
+        int pos_;                  // next write position in buf_
+        int countdown_;            // samples until the next window
+    };
+
+
+    template <typename X, typename F>
+    int SlidingCorrelation::apply(const Eigen::ArrayBase<X>& x, F&& f)
+    {
+        setup(static_cast<int>(x.rows()));
+
+        int frames = 0;
+
+        for (Eigen::DenseIndex i = 0; i < x.cols(); )
+        {
+            const int n = std::min({ countdown_, window_ - pos_, static_cast<int>(x.cols() - i) });
+            buf_.middleCols(pos_, n) = x.middleCols(i, n).template cast<float>();
+            i += n;
+            pos_ = (pos_ + n) % window_;
+
+            if ((countdown_ -= n) == 0)
+            {
+                correlate_window();
+                f(static_cast<const Eigen::ArrayXXf&>(result_));
+                countdown_ = hop_;
+                ++frames;
+            }
+        }
+
+        return frames;
+    }
+
+}
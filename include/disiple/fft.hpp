@@ -2,23 +2,120 @@
 
 #include <Eigen/Core>
 #include <memory>
+#include <unordered_map>
 
 namespace disiple {
 
-    /// 1d half-spectrum real-to-complex fft
+    namespace internal { class FFTBackendImpl; }
+
+    /// Available fft implementations. Eigen's KissFFT is always compiled in,
+    /// PFFFT and Accelerate only if enabled in the build (USE_PFFFT,
+    /// USE_ACCELERATE). Default picks the fastest one available.
+    enum class FFTBackend
+    {
+        Default,
+        Eigen,
+        PFFFT,
+        Accelerate
+    };
+
+    /// Whether the backend was compiled into the library
+    bool fft_backend_available(FFTBackend backend);
+
+    /// 1d fft: half-spectrum real-to-complex and complex-to-complex,
+    /// forward and inverse. Inverse transforms are scaled by 1/length.
+    /// All transforms are re-entrant: scratch memory is thread-local, so
+    /// a single instance can be shared between threads.
+    /// Any length is supported: lengths the backend handles natively
+    /// (mixed radix 2/3/5, see fft_fast_length) are transformed directly,
+    /// all others via Bluestein's algorithm.
     class FFT
     {
     public:
-        explicit FFT(size_t length);
+        /// @throws std::invalid_argument if the backend is not available
+        explicit FFT(size_t length, FFTBackend backend = FFTBackend::Default);
+
+        size_t length() const { return len_; }
+
+        /// The backend in use, never Default
+        FFTBackend backend() const { return backend_; }
+
+        /// Forward real-to-complex transform
+        /// @param x Input, length
+        /// @param y Output half spectrum, length/2+1
         void operator()(Eigen::Ref<const Eigen::ArrayXf, Eigen::Aligned>x ,
                         Eigen::Ref<Eigen::ArrayXcf, Eigen::Aligned> y) const;
 
+        /// Inverse complex-to-real transform
+        /// @param y Input half spectrum, length/2+1
+        /// @param x Output, length
+        void inverse(Eigen::Ref<const Eigen::ArrayXcf, Eigen::Aligned> y,
+                     Eigen::Ref<Eigen::ArrayXf, Eigen::Aligned> x) const;
+
+        /// Forward complex-to-complex transform, x and y of size length
+        void complex_forward(Eigen::Ref<const Eigen::ArrayXcf, Eigen::Aligned> x,
+                             Eigen::Ref<Eigen::ArrayXcf, Eigen::Aligned> y) const;
+
+        /// Inverse complex-to-complex transform, y and x of size length
+        void complex_inverse(Eigen::Ref<const Eigen::ArrayXcf, Eigen::Aligned> y,
+                             Eigen::Ref<Eigen::ArrayXcf, Eigen::Aligned> x) const;
+
+        /// Forward real-to-complex transform of every channel
+        /// @param x Input, channels-by-length
+        /// @param y Output half spectra, channels-by-(length/2+1)
+        void batch(const Eigen::Ref<const Eigen::ArrayXXf>& x,
+                   Eigen::Ref<Eigen::ArrayXXcf> y) const;
+
+        /// Inverse complex-to-real transform of every channel
+        /// @param y Input half spectra, channels-by-(length/2+1)
+        /// @param x Output, channels-by-length
+        void batch_inverse(const Eigen::Ref<const Eigen::ArrayXXcf>& y,
+                           Eigen::Ref<Eigen::ArrayXXf> x) const;
+
     private:
-        struct ImplDeleter { void operator()(void* p) const; };
-        std::unique_ptr<void, ImplDeleter>  impl_;
-        size_t                              len_;
-        unsigned int                        loglen_;
-        mutable Eigen::ArrayXf              work_;
+        using CF = std::complex<float>;
+
+        // the actual transforms on contiguous, aligned memory
+        void fwd (const float* x, CF* y) const;
+        void inv (const CF* y, float* x) const;
+        void cfwd(const CF* x, CF* y) const;
+        void cinv(const CF* y, CF* x) const;
+
+        struct Bluestein;
+
+        std::shared_ptr<const internal::FFTBackendImpl> impl_;
+        std::shared_ptr<const Bluestein>                bluestein_;
+        size_t                                          len_;
+        FFTBackend                                      backend_;
+    };
+
+    /// Smallest length >= n that the fft backend transforms natively,
+    /// useful to choose the amount of zero padding.
+    size_t fft_fast_length(size_t n, FFTBackend backend = FFTBackend::Default);
+
+    /// Registry of FFT plans, keyed by length and shared between threads,
+    /// plus per-thread scratch buffers. Each thread caches the plans it
+    /// has looked up, so only the first lookup of a length takes a lock.
+    class FFTRegistry
+    {
+    public:
+        /// The registry of the calling thread
+        static FFTRegistry& local();
+
+        /// Plan for an fft of the given length, created on first use
+        const FFT& plan(size_t length);
+
+        /// Scratch buffers, resized to the given size if necessary
+        Eigen::ArrayXf&  real_buffer(size_t size);
+        Eigen::ArrayXcf& complex_buffer(size_t size);
+
+    private:
+        FFTRegistry() {}
+        FFTRegistry(const FFTRegistry&) = delete;
+
+        std::unordered_map<size_t, const FFT*>  plans_;
+        Eigen::ArrayXf                          real_;
+        Eigen::ArrayXcf                         complex_;
     };
 
 }
@@ -4,6 +4,7 @@
 #include <disiple/impl/iir_sos.hpp>
 #include <disiple/impl/iir_impl.hpp>
 #include <disiple/filter_design.hpp>
+#include <disiple/static_design.hpp>
 #include <disiple/named_params.hpp>
 
 namespace disiple {
@@ -28,6 +29,9 @@ namespace disiple {
         IIR() {}
         IIR(IIRDesign const& d) : coeffs_(d) {}
 
+        template <int S>
+        IIR(StaticIIRDesign<Scalar, S> const& d) : coeffs_(d) {}
+
         int num_stages() const { return coeffs_.num_stages(); }
         
     private:
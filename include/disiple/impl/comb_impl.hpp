@@ -0,0 +1,91 @@
+#pragma once
+
+#include <disiple/impl/fir_impl.hpp>
+#include <disiple/impl/maybe_static.hpp>
+#include <disiple/impl/pole_zero_pair.hpp>
+#include <Eigen/Core>
+#include <cmath>
+#include <stdexcept>
+
+namespace disiple {
+
+    // recursive comb filter
+
+    template <typename Scalar, int Length>
+    struct CombCoeffs : private MaybeStatic<Length>
+    {
+        CombCoeffs() : MaybeStatic<Length>(Length == Eigen::Dynamic ? 1 : Length), g_(1), r_(0) {}
+
+        /// Same response as comb(N, BW), but in closed form:
+        ///     H(z) = g (1 - z^-N) / (1 - r z^-N)
+        CombCoeffs(int n, double bw)
+        : MaybeStatic<Length>(n)
+        {
+            if (n < 1)
+                throw std::invalid_argument("Comb length must be positive");
+
+            const double gain = 1.0/(1.0+std::tan(0.25*n*bw*pi));
+            g_ = Scalar(gain);
+            r_ = Scalar(2*gain - 1);
+        }
+
+        int length() const { return MaybeStatic<Length>::get(); }
+
+        Scalar g_, r_;
+    };
+
+    template <typename Scalar, int Length, int Channels>
+    struct CombState : FIRState<Scalar, Length, Channels>
+    {
+        using Base = FIRState<Scalar, Length, Channels>;
+
+        CombState() : Base() {}
+
+        using Base::initialize;
+        using Base::advance;
+
+        void setup(const CombCoeffs<Scalar, Length>& coeffs, int nchans)
+        {
+            Base::setup(coeffs, nchans);
+            w_.resize(nchans);
+        }
+
+        template <typename X>
+        void initialize(const CombCoeffs<Scalar, Length>& coeffs,
+                        const Eigen::ArrayBase<X>& x_ss)
+        {
+            // the delay line holds w = x / (1 - r) in steady state
+            w_ = x_ss / (Scalar(1) - coeffs.r_);
+            buf_ = w_.matrix().replicate(1, buf_.cols());
+        }
+
+        template <typename X>
+        void apply(const CombCoeffs<Scalar, Length>& coeffs,
+                   Eigen::ArrayBase<X>& xi)
+        {
+            // direct form 2 on a single delay line of length N:
+            //     w[n] = x[n] + r * w[n-N]
+            //     y[n] = g * (w[n] - w[n-N])
+
+            advance();
+            auto wN = buf_.col(pos_).array();
+            w_ = xi + coeffs.r_ * wN;
+            xi = coeffs.g_ * (w_ - wN);
+            wN = w_;
+        }
+
+        template <typename X>
+        void apply(const CombCoeffs<Scalar, Length>& coeffs,
+                   const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            advance();
+            auto wN = buf_.col(pos_).array();
+            wN = xi + coeffs.r_ * wN;
+        }
+
+        Eigen::Array<Scalar, Channels, 1> w_;
+        using Base::buf_;
+        using Base::pos_;
+    };
+
+}
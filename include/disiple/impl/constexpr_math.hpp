@@ -0,0 +1,90 @@
+#pragma once
+
+#include <disiple/impl/pole_zero_pair.hpp>
+
+namespace disiple {
+
+namespace cx {
+
+    // Minimal compile-time replacements for <cmath> and std::complex,
+    // which are not usable in constant expressions before C++20.
+
+    constexpr double reduce_angle(double x)
+    {
+        // wrap x into [-pi, pi]
+        const double k = x / two_pi;
+        const long long n = static_cast<long long>(k >= 0 ? k + 0.5 : k - 0.5);
+        return x - two_pi * static_cast<double>(n);
+    }
+
+    constexpr double sin(double x)
+    {
+        x = reduce_angle(x);
+        double term = x, sum = x;
+        for (int i = 1; i < 32; ++i) {
+            term *= -x * x / double((2*i) * (2*i+1));
+            sum  += term;
+        }
+        return sum;
+    }
+
+    constexpr double cos(double x)
+    {
+        x = reduce_angle(x);
+        double term = 1, sum = 1;
+        for (int i = 1; i < 32; ++i) {
+            term *= -x * x / double((2*i-1) * (2*i));
+            sum  += term;
+        }
+        return sum;
+    }
+
+    constexpr double tan(double x) { return sin(x) / cos(x); }
+
+    constexpr double abs(double x) { return x < 0 ? -x : x; }
+
+    constexpr double sqrt(double x)
+    {
+        if (x <= 0)
+            return 0;
+        double y = x < 1 ? 1 : x;
+        for (int i = 0; i < 128; ++i) {
+            const double z = 0.5 * (y + x / y);
+            if (z == y)
+                break;
+            y = z;
+        }
+        return y;
+    }
+
+    struct complex
+    {
+        double re, im;
+
+        constexpr complex(double r = 0, double i = 0) : re(r), im(i) {}
+
+        constexpr double real() const { return re; }
+        constexpr double imag() const { return im; }
+    };
+
+    constexpr complex operator+(complex a, complex b) { return { a.re + b.re, a.im + b.im }; }
+    constexpr complex operator-(complex a, complex b) { return { a.re - b.re, a.im - b.im }; }
+
+    constexpr complex operator*(complex a, complex b)
+    {
+        return { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+    }
+
+    constexpr complex operator/(complex a, complex b)
+    {
+        const double d = b.re * b.re + b.im * b.im;
+        return { (a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d };
+    }
+
+    constexpr complex conj(complex a) { return { a.re, -a.im }; }
+    constexpr double  norm(complex a) { return a.re * a.re + a.im * a.im; }
+    constexpr double  abs (complex a) { return sqrt(norm(a)); }
+
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+
+namespace disiple {
+
+    enum class FFTBackend;
+
+namespace internal {
+
+    // Interface of an fft implementation of a fixed length. The transforms
+    // operate on contiguous, aligned memory, inverses are scaled by 1/length.
+    // Implementations must be re-entrant, see fft_work() for scratch memory.
+    class FFTBackendImpl
+    {
+    public:
+        using CF = std::complex<float>;
+
+        virtual ~FFTBackendImpl() {}
+
+        virtual void fwd (const float* x, CF* y) const = 0;
+        virtual void inv (const CF* y, float* x) const = 0;
+        virtual void cfwd(const CF* x, CF* y) const = 0;
+        virtual void cinv(const CF* y, CF* x) const = 0;
+    };
+
+    // Thread-local, aligned scratch memory of at least n floats
+    float* fft_work(size_t n);
+
+    // Backend factories, only defined if the backend is compiled in.
+    // Each requires a length for which *_native_length() is true.
+    std::unique_ptr<FFTBackendImpl> make_eigen_fft(size_t n);
+    std::unique_ptr<FFTBackendImpl> make_pffft(size_t n);
+    std::unique_ptr<FFTBackendImpl> make_accelerate_fft(size_t n);
+
+}
+
+}
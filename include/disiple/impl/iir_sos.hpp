@@ -1,6 +1,7 @@
 #pragma once
 
 #include <disiple/filter_design.hpp>
+#include <disiple/static_design.hpp>
 #include <stdexcept>
 #include <string>
 
@@ -18,6 +19,9 @@ namespace disiple {
         SecondOrderSections() : scaling_(1) { coeffs_.setZero(); }
         SecondOrderSections(const IIRDesign& l);
 
+        template <int S>
+        SecondOrderSections(const StaticIIRDesign<Scalar, S>& d);
+
         std::complex<Scalar> response(Scalar f) const;
 
         template <typename F, typename Z>
@@ -82,6 +86,15 @@ namespace disiple {
         scaling_ = Scalar(l.normal_gain()) / std::abs(response(Scalar(l.normal_w())));
     }
 
+    template <typename Scalar, int Stages>
+    template <int S>
+    SecondOrderSections<Scalar, Stages>::SecondOrderSections(const StaticIIRDesign<Scalar, S>& d)
+    : coeffs_(Eigen::Map<const Eigen::Array<Scalar, 4, S>>(&d.coeffs[0][0]))
+    , scaling_(d.scaling)
+    {
+        static_assert(Stages == Eigen::Dynamic || Stages == S, "Static size is wrong");
+    }
+
     template <typename Scalar, int Stages>
     std::complex<Scalar> SecondOrderSections<Scalar, Stages>::response(Scalar f) const
     {
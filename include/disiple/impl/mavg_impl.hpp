@@ -1,11 +1,51 @@
 #pragma once
 
+#include <disiple/impl/filter_base.hpp>
 #include <disiple/impl/fir_impl.hpp>
 #include <disiple/impl/maybe_static.hpp>
 #include <Eigen/Core>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace disiple {
 
+    /// How running sums are kept from drifting due to rounding errors
+    enum SummationMode
+    {
+        Plain,       ///< No correction, exact for integral Scalar types
+        Resync,      ///< A shadow sum restarts every Length samples and replaces the running sum
+        Compensated  ///< Compensated (Kahan-Babuska) summation, the running sum never drifts
+    };
+
+    /// Option choosing the SummationMode of filters with running sums
+    template <SummationMode N>
+    struct Summation { static constexpr SummationMode summation = N; };
+
+    // s + c += v, where c collects the low order bits lost in s.
+    // Knuth's branch-free TwoSum gives the exact rounding error of s + v;
+    // it must not be compiled with -ffast-math.
+    template <typename Scalar, int Rows>
+    struct CompensatedSum
+    {
+        void resize(Eigen::DenseIndex rows) { tmp_.resize(rows, 2); }
+
+        template <typename S, typename C, typename V>
+        void add(S&& s, C&& c, const V& v)
+        {
+            auto t  = tmp_.col(0).head(s.size());
+            auto vv = tmp_.col(1).head(s.size());
+            t  = s + v;
+            vv = t - s;
+            c += (s - (t - vv)) + (v - vv);
+            s  = t;
+        }
+
+        Eigen::Array<Scalar, Rows, 2> tmp_;
+    };
+
     template <typename Scalar, int Length, int Stages>
     struct MAvgCoeffs
     : private MaybeStatic<Length, void>  // inheritance enables empty base-class optimization
@@ -26,7 +66,12 @@ namespace disiple {
         enum { value = A != Eigen::Dynamic && B != Eigen::Dynamic ? A*B : Eigen::Dynamic };
     };
 
-    template <typename Scalar, int Length, int Channels, int Stages>
+    // The history of all stages lives in one ring buffer: each column holds
+    // the inputs of every stage and channel at one time, so a sample touches
+    // a single contiguous column. Its Stages*Length samples per channel are
+    // (up to Stages-1) the minimum any exact cascade needs: the output
+    // depends on the last Stages*(Length-1)+1 inputs.
+    template <typename Scalar, int Length, int Channels, int Stages, SummationMode Mode = Resync>
     struct MAvgState : FIRState<Scalar, Length, multiply_extents<Channels, Stages>::value>
     {
         enum { Rows = multiply_extents<Channels, Stages>::value };
@@ -48,7 +93,11 @@ namespace disiple {
             {
                 Base::buf_.resize(rws, len);
                 sum_.resize(nchans, coeffs.stages());
-                correct_sum_.resize(nchans, coeffs.stages());
+                // only allocate what the summation mode uses
+                if (Mode != Plain)
+                    correct_sum_.resize(nchans, coeffs.stages());
+                if (Mode == Compensated)
+                    comp_.resize(rws);
                 initialize();
             }
         }
@@ -70,12 +119,16 @@ namespace disiple {
             enum { A = Rows != 1 ? Aligned : Unaligned };
 
             Map<Array<Scalar, Rows, 1>, A> vsum(sum_.data(), buf_.rows(), 1);
+            Map<Array<Scalar, Rows, 1>, A> vcorr(correct_sum_.data(), buf_.rows(), 1);
 
             advance();
 
-            if (num_ == buf_.cols())
-                vsum -= buf_.col(pos_).array();
-            else
+            if (num_ == buf_.cols()) {
+                if (Mode == Compensated)
+                    comp_.add(vsum, vcorr, -buf_.col(pos_).array());
+                else
+                    vsum -= buf_.col(pos_).array();
+            } else
                 ++num_;
 
             const auto nchans = sum_.rows();
@@ -83,12 +136,18 @@ namespace disiple {
             for (int i = 0; i < coeffs.stages(); ++i)
             {
                 buf_.template block<Channels, 1>(i * nchans, pos_, nchans, 1) = xi;
-                correct_sum_.col(i) += xi;
-                sum_.col(i) += xi;
-                xi = sum_.col(i) / num;
+                if (Mode == Compensated) {
+                    comp_.add(sum_.col(i), correct_sum_.col(i), xi);
+                    xi = (sum_.col(i) + correct_sum_.col(i)) / num;
+                } else {
+                    if (Mode == Resync)
+                        correct_sum_.col(i) += xi;
+                    sum_.col(i) += xi;
+                    xi = sum_.col(i) / num;
+                }
             }
 
-            if (--correct_num_ == 0) {
+            if (Mode == Resync && --correct_num_ == 0) {
                 sum_ = correct_sum_;
                 correct_sum_.setZero();
                 correct_num_ = static_cast<int>(buf_.cols());
@@ -99,11 +158,135 @@ namespace disiple {
         using Base::advance;
         using Base::buf_;
         using Base::pos_;
-        Eigen::Array<Scalar, Channels, Stages> sum_, correct_sum_;
+        Eigen::Array<Scalar, Channels, Stages> sum_;
+        Eigen::Array<Scalar, Channels, Stages> correct_sum_; ///< Resync: shadow sum, Compensated: compensation
+        CompensatedSum<Scalar, Rows> comp_;
         int num_, correct_num_;
     };
 
 
+    // moving averages of several lengths over one shared history
+
+    template <typename Scalar>
+    struct MultiMAvgCoeffs
+    {
+        MultiMAvgCoeffs() : lengths_(1, 1), max_(1) {}
+
+        explicit MultiMAvgCoeffs(std::vector<int> lengths)
+        : lengths_(std::move(lengths)), max_(0)
+        {
+            if (lengths_.empty())
+                throw std::invalid_argument("At least one length is required");
+            for (int l : lengths_) {
+                if (l < 1)
+                    throw std::invalid_argument("Lengths must be positive");
+                max_ = std::max(max_, l);
+            }
+        }
+
+        /// Length of the shared history, i.e. of the longest window
+        int length()      const { return max_; }
+        int num_lengths() const { return static_cast<int>(lengths_.size()); }
+
+        std::vector<int> lengths_;
+        int max_;
+    };
+
+    template <typename Scalar, int Channels, SummationMode Mode = Resync>
+    struct MultiMAvgState : FIRState<Scalar, Eigen::Dynamic, Channels>
+    {
+        using Base   = FIRState<Scalar, Eigen::Dynamic, Channels>;
+        using Coeffs = MultiMAvgCoeffs<Scalar>;
+
+        MultiMAvgState() : num_(0) {}
+
+        void setup(const Coeffs& coeffs, int nchans)
+        {
+            if (Base::num_chans() != nchans ||
+                Base::length()    != coeffs.length() ||
+                sum_.cols()       != coeffs.num_lengths())
+            {
+                buf_.resize(nchans, coeffs.length());
+                sum_.resize(nchans, coeffs.num_lengths());
+                if (Mode != Plain)
+                    correct_sum_.resize(nchans, coeffs.num_lengths());
+                if (Mode == Compensated)
+                    comp_.resize(nchans);
+                lengths_ = coeffs.lengths_;
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            Base::initialize();
+            sum_.setZero(); correct_sum_.setZero();
+            num_ = 0;       correct_num_ = lengths_;
+        }
+
+        /// @param yi Output, the averages of all lengths stacked:
+        ///           row k*channels+c holds length k of channel c
+        template <typename X, typename Y>
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi, Eigen::ArrayBase<Y>& yi)
+        {
+            const int len    = static_cast<int>(buf_.cols());
+            const int nchans = static_cast<int>(buf_.rows());
+
+            advance();
+            if (num_ <= len)
+                ++num_;
+
+            // remove the samples leaving each window; for the longest window
+            // that is the one at pos_, which is overwritten next
+            for (int k = 0; k < coeffs.num_lengths(); ++k)
+            {
+                const int l = coeffs.lengths_[k];
+                if (num_ > l) {
+                    auto old = buf_.col((pos_ + l) % len).array();
+                    if (Mode == Compensated)
+                        comp_.add(sum_.col(k), correct_sum_.col(k), -old);
+                    else
+                        sum_.col(k) -= old;
+                }
+            }
+
+            buf_.col(pos_) = xi;
+
+            for (int k = 0; k < coeffs.num_lengths(); ++k)
+            {
+                const int l = coeffs.lengths_[k];
+                const Scalar num = Scalar(std::min(num_, l));
+                auto yk = yi.segment(k * nchans, nchans);
+
+                if (Mode == Compensated) {
+                    comp_.add(sum_.col(k), correct_sum_.col(k), xi);
+                    yk = (sum_.col(k) + correct_sum_.col(k)) / num;
+                } else {
+                    if (Mode == Resync)
+                        correct_sum_.col(k) += xi;
+                    sum_.col(k) += xi;
+                    yk = sum_.col(k) / num;
+                }
+
+                if (Mode == Resync && --correct_num_[k] == 0) {
+                    sum_.col(k) = correct_sum_.col(k);
+                    correct_sum_.col(k).setZero();
+                    correct_num_[k] = l;
+                }
+            }
+        }
+
+        using Base::advance;
+        using Base::buf_;
+        using Base::pos_;
+        Eigen::Array<Scalar, Channels, Eigen::Dynamic> sum_;
+        Eigen::Array<Scalar, Channels, Eigen::Dynamic> correct_sum_; ///< Resync: shadow sums, Compensated: compensation
+        CompensatedSum<Scalar, Channels> comp_;
+        std::vector<int> lengths_, correct_num_;
+        int num_;
+    };
+
+
     // cumulative moving average
 
     template <typename Scalar>
@@ -155,4 +338,217 @@ namespace disiple {
         int num_;
     };
 
+
+    // cumulative mean, variance, min and max
+
+    template <typename Scalar, int Channels>
+    struct CumStatsState
+    {
+        static_assert(std::is_floating_point<Scalar>::value,
+                      "Cumulative statistics need a floating point Scalar");
+
+        using Vec = Eigen::Array<Scalar, Channels, 1>;
+
+        CumStatsState() : num_(0)
+        {
+            if (Channels != Eigen::Dynamic)
+                initialize();
+        }
+
+        void setup(const CumMAvgCoeffs<Scalar>&, int nchans)
+        {
+            if (mean_.size() != nchans)
+            {
+                mean_.resize(nchans); m2_.resize(nchans);
+                min_.resize(nchans);  max_.resize(nchans);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            mean_.setZero(); m2_.setZero();
+            min_.setConstant( std::numeric_limits<Scalar>::infinity());
+            max_.setConstant(-std::numeric_limits<Scalar>::infinity());
+            num_ = 0;
+        }
+
+        template <typename X>
+        void apply(const CumMAvgCoeffs<Scalar>& coeffs, Eigen::ArrayBase<X>& xi)
+        {
+            apply(coeffs, xi, dry_run);
+            xi = mean_;
+        }
+
+        template <typename X>
+        void apply(const CumMAvgCoeffs<Scalar>&, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            // Welford's update
+            ++num_;
+            const Vec d = xi - mean_;
+            mean_ += d / Scalar(num_);
+            m2_   += d * (xi - mean_);
+            min_ = min_.min(xi);
+            max_ = max_.max(xi);
+        }
+
+        // Statistics of a whole block (channels-by-time), merged in
+        template <typename X>
+        void apply_block(const Eigen::ArrayBase<X>& x)
+        {
+            if (x.cols() == 0)
+                return;
+
+            CumStatsState b;
+            b.num_  = x.cols();
+            b.mean_ = x.rowwise().mean();
+            b.m2_   = (x.colwise() - b.mean_).square().rowwise().sum();
+            b.min_  = x.rowwise().minCoeff();
+            b.max_  = x.rowwise().maxCoeff();
+            merge(b);
+        }
+
+        // Chan et al.'s pairwise combination of partial results
+        void merge(const CumStatsState& b)
+        {
+            if (b.num_ == 0)
+                return;
+            if (num_ == 0) {
+                *this = b;
+                return;
+            }
+
+            const long long n = num_ + b.num_;
+            const Vec d = b.mean_ - mean_;
+            const Scalar wb = Scalar(b.num_) / Scalar(n);
+            mean_ += d * wb;
+            m2_   += b.m2_ + d.square() * (Scalar(num_) * wb);
+            min_ = min_.min(b.min_);
+            max_ = max_.max(b.max_);
+            num_ = n;
+        }
+
+        Vec mean_, m2_, min_, max_;
+        long long num_;
+    };
+
+
+    // exponentially weighted moving average and variance
+
+    template <typename Scalar>
+    struct EMACoeffs
+    {
+        EMACoeffs() : alpha_(1) {}
+
+        /// @param alpha Weight of a new sample, in (0,1]
+        explicit EMACoeffs(double alpha) : alpha_(Scalar(alpha))
+        {
+            if (alpha <= 0.0 || alpha > 1.0)
+                throw std::invalid_argument("Alpha must be in (0,1]");
+        }
+
+        static int length() { return 1; }
+
+        Scalar alpha_;
+    };
+
+    // The mean (and variance, if Variance is set) of all samples so far,
+    // where a sample of age k has weight alpha*(1-alpha)^k. The first
+    // sample after initialize() seeds the mean.
+    template <typename Scalar, int Channels, bool Variance>
+    struct EMAState
+    {
+        EMAState() : decay_(1), weights_alpha_(0), primed_(false)
+        {
+            if (Channels != Eigen::Dynamic)
+                initialize();
+        }
+
+        void setup(const EMACoeffs<Scalar>&, int nchans)
+        {
+            if (mean_.size() != nchans)
+            {
+                mean_.resize(nchans);
+                var_.resize(nchans);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            mean_.setZero(); var_.setZero(); primed_ = false;
+        }
+
+        template <typename X>
+        void initialize(const EMACoeffs<Scalar>&, const Eigen::ArrayBase<X>& x_ss)
+        {
+            mean_ = x_ss; var_.setZero(); primed_ = true;
+        }
+
+        template <typename X>
+        void apply(const EMACoeffs<Scalar>& coeffs, Eigen::ArrayBase<X>& xi)
+        {
+            apply(coeffs, xi, dry_run);
+            if (Variance)
+                xi = var_;
+            else
+                xi = mean_;
+        }
+
+        template <typename X>
+        void apply(const EMACoeffs<Scalar>& coeffs, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            if (!primed_) {
+                mean_ = xi; primed_ = true;
+                return;
+            }
+
+            const Scalar a = coeffs.alpha_;
+            if (Variance) {
+                // West's incremental update:
+                //     v <- (1-a) * (v + a * (x - m)^2)
+                var_ = (Scalar(1) - a) * (var_ + a * (xi - mean_).square());
+            }
+            mean_ += a * (xi - mean_);
+        }
+
+        // Update with a whole block (channels-by-time) in closed form:
+        // with weights w_k = (1-a)^(N-1-k) and d = x - m,
+        //     m <- m + a * sum_k w_k d_k
+        //     v <- (1-a)^N v + a * sum_k w_k d_k^2 - (a * sum_k w_k d_k)^2
+        // i.e. a matrix-vector product instead of a serial recurrence.
+        template <typename X>
+        void apply_block(const EMACoeffs<Scalar>& coeffs, const Eigen::ArrayBase<X>& x)
+        {
+            Eigen::DenseIndex n = x.cols(), first = 0;
+            if (n == 0)
+                return;
+            if (!primed_) {
+                mean_ = x.col(0); primed_ = true;
+                first = 1; --n;
+            }
+
+            const Scalar a = coeffs.alpha_;
+            if (weights_.size() != n || weights_alpha_ != a) {
+                weights_.resize(n);
+                Scalar w = 1;
+                for (Eigen::DenseIndex k = n-1; k >= 0; --k, w *= Scalar(1) - a)
+                    weights_[k] = w;
+                decay_ = w;
+                weights_alpha_ = a;
+            }
+
+            const auto d = x.middleCols(first, n).colwise() - mean_;
+            const Eigen::Array<Scalar, Channels, 1> dm = a * (d.matrix() * weights_.matrix()).array();
+            if (Variance)
+                var_ = decay_ * var_ + a * (d.square().matrix() * weights_.matrix()).array() - dm.square();
+            mean_ += dm;
+        }
+
+        Eigen::Array<Scalar, Channels, 1> mean_, var_;
+        Eigen::Array<Scalar, Eigen::Dynamic, 1> weights_;  // cached for the last block length
+        Scalar decay_, weights_alpha_;
+        bool primed_;
+    };
+
 }
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <disiple/impl/filter_base.hpp>
+#include <disiple/impl/running_stats_impl.hpp>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+namespace disiple {
+
+    /// Elementary morphological operation with a flat structuring element
+    enum class MorphologyOp
+    {
+        Erode,  ///< Minimum over the structuring element
+        Dilate  ///< Maximum over the structuring element
+    };
+
+    template <typename Scalar>
+    struct MorphologyCoeffs
+    {
+        MorphologyCoeffs() : len_(1), ops_(1, MorphologyOp::Erode) {}
+
+        MorphologyCoeffs(int len, std::initializer_list<MorphologyOp> ops)
+        : len_(len), ops_(ops)
+        {
+            if (len < 1 || len % 2 == 0)
+                throw std::invalid_argument("Morphology: the structuring element must have an odd length");
+        }
+
+        static Scalar scaling() { return Scalar(1); }
+        int length() const { return len_; }
+        int stages() const { return static_cast<int>(ops_.size()); }
+
+        /// Each stage lags by half the structuring element
+        int delay() const { return stages() * (len_ - 1) / 2; }
+
+        int len_;
+        std::vector<MorphologyOp> ops_;
+    };
+
+    /// A cascade of erosions and dilations, computed in a single pass: every
+    /// stage has its own Lemire wedge, a minimum wedge for erosions and a
+    /// maximum wedge for dilations, and feeds the next one sample by sample.
+    /// Until all stages are fed, i.e. for the first delay() samples, the
+    /// output is the partial result of the stages reached so far.
+    template <typename Scalar, int Channels>
+    struct MorphologyState
+    {
+        using Coeffs   = MorphologyCoeffs<Scalar>;
+        using MinQueue = MonotonicQueue<Scalar, Channels, std::less>;
+        using MaxQueue = MonotonicQueue<Scalar, Channels, std::greater>;
+
+        MorphologyState() : t_(0) {}
+
+        void setup(const Coeffs& coeffs, int nchans)
+        {
+            // each stage only uses the queue of its own kind
+            if (int(min_.size()) != coeffs.stages()) {
+                min_.resize(coeffs.stages());
+                max_.resize(coeffs.stages());
+            }
+            for (int s = 0; s < coeffs.stages(); ++s)
+                if (coeffs.ops_[s] == MorphologyOp::Dilate)
+                    max_[s].setup(nchans, coeffs.length());
+                else
+                    min_[s].setup(nchans, coeffs.length());
+        }
+
+        void initialize()
+        {
+            for (MinQueue& q : min_)
+                q.initialize();
+            for (MaxQueue& q : max_)
+                q.initialize();
+            t_ = 0;
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi)
+        {
+            for (int c=0; c<xi.size(); ++c)
+                xi[c] = push(coeffs, c, xi[c]);
+            ++t_;
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            for (int c=0; c<xi.size(); ++c)
+                push(coeffs, c, xi[c]);
+            ++t_;
+        }
+
+        Scalar push(const Coeffs& coeffs, int c, Scalar v)
+        {
+            const int half = (coeffs.length() - 1) / 2;
+
+            for (int s = 0; s < coeffs.stages(); ++s)
+            {
+                // the first half outputs of a stage are centered on
+                // samples before the start, which the next stage skips
+                if (t_ < s * half)
+                    break;
+
+                if (coeffs.ops_[s] == MorphologyOp::Dilate) {
+                    max_[s].push(c, t_, v);
+                    v = max_[s].front(c);
+                } else {
+                    min_[s].push(c, t_, v);
+                    v = min_[s].front(c);
+                }
+            }
+            return v;
+        }
+
+        std::vector<MinQueue, Eigen::aligned_allocator<MinQueue>> min_;
+        std::vector<MaxQueue, Eigen::aligned_allocator<MaxQueue>> max_;
+        long long t_;
+    };
+
+}
@@ -6,9 +6,9 @@
 
 namespace disiple {
 
-    static const double pi      = 3.1415926535897932384626433832795028841971;
-    static const double two_pi  = pi * 2.0;
-    static const double pi_half = pi * 0.5;
+    static constexpr double pi      = 3.1415926535897932384626433832795028841971;
+    static constexpr double two_pi  = pi * 2.0;
+    static constexpr double pi_half = pi * 0.5;
     using Complex = std::complex<double>;
 
     struct ComplexPair : std::pair<Complex, Complex>
@@ -2,6 +2,8 @@
 
 #include <Eigen/Core>
 #include <disiple/impl/mavg_impl.hpp>
+#include <cmath>
+#include <memory>
 
 namespace disiple {
 
@@ -12,13 +14,26 @@ namespace disiple {
     {
         using Base = MAvgCoeffs<Scalar, Length, Stages>;
 
-        PolyFIRCoeffs() {}
+        /// All weights zero, with a window of Length or, if dynamic, 1
+        PolyFIRCoeffs() :
+            Base(Length == Eigen::Dynamic ? 1 : Length, Stages),
+            p_(Eigen::Array<Scalar, Stages, J>::Zero()), q_(Eigen::Array<Scalar, Stages, K>::Zero())
+        {
+            build_table();
+        }
 
         template <typename P, typename Q>
         explicit PolyFIRCoeffs(const Eigen::ArrayBase<P>& p, const Eigen::ArrayBase<Q>& q, int wlen) :
             Base(wlen, p.rows()), p_(p), q_(q)
-        {}
+        {
+            build_table();
+        }
+
+        /// Coefficients of the cascaded sums for a window holding n
+        /// samples, 1 <= n <= length()
+        auto weights(int n) const { return table_->col(n-1); }
 
+        /// Coefficients a_i(n) of the powers t^i of the weights
         template <typename A>
         void update(Scalar n, Eigen::ArrayBase<A>& a) const
         {
@@ -32,16 +47,64 @@ namespace disiple {
             a = (sum_q == 0).select(Scalar(0), sum_p / sum_q);
         }
 
+        using Table = Eigen::Array<Scalar, Stages, Eigen::Dynamic>;
+
+        // Stage i of the cascade weighs the sample of age k = t-1 with
+        // C(k+i, i), so the powers t^i are rewritten in that basis: with
+        // B(j,m) = C(m+j, j) = (L L')(j,m), L the lower Pascal matrix, and
+        // P(i,m) = (m+1)^i, the weights a P become b B for b = a P B^-1.
+        // The inverse of L is integer, (-1)^(m-j) C(m,j), so is the result.
+        // The table holds b for every window length up to length(), so that
+        // filling the window costs no more than the steady state; copies
+        // of the coefficients share the table.
+        void build_table()
+        {
+            const int wlen = Base::length(), stages = static_cast<int>(p_.rows());
+
+            Eigen::MatrixXd linv = Eigen::MatrixXd::Zero(stages, stages), pow(stages, stages);
+            for (int m = 0; m < stages; ++m)
+                for (int j = 0; j <= m; ++j)
+                    linv(m, j) = (j == 0 || j == m) ? ((m - j) % 2 ? -1 : 1)
+                                                    : linv(m-1, j-1) - linv(m-1, j);
+            for (int i = 0; i < stages; ++i)
+                for (int m = 0; m < stages; ++m)
+                    pow(i, m) = std::pow(double(m + 1), i);
+            const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> basis =
+                (pow * linv.transpose() * linv).transpose().cast<Scalar>();
+
+            auto table = std::make_shared<Table>(stages, wlen);
+            Eigen::Array<Scalar, Stages, 1> a(stages);
+            for (int n = 1; n <= wlen; ++n) {
+                update(Scalar(n), a);
+                table->col(n-1) = (basis * a.matrix()).array();
+            }
+            table_ = std::move(table);
+
+            // the weight C(wlen-1+i, i) of the sample leaving stage i
+            removal_.resize(stages);
+            double r = 1;
+            for (int i = 0; i < stages; ++i) {
+                removal_[i] = Scalar(r);
+                r *= double(wlen + i) / double(i + 1);
+            }
+        }
+
         Eigen::Array<Scalar, Stages, J>  p_;
         Eigen::Array<Scalar, Stages, K>  q_;
+        std::shared_ptr<const Table>     table_;
+        Eigen::Array<Scalar, Stages, 1>  removal_;
     };
 
-    template <typename Scalar, int Length, int Channels, int Stages>
+    // The cascaded sums are updated recursively. Against the rounding
+    // errors that accumulate in them, Resync keeps shadow sums which
+    // restart every Length samples and then replace them, and Compensated
+    // keeps the compensation of every sum, as MAvgState does.
+    template <typename Scalar, int Length, int Channels, int Stages, SummationMode Mode = Resync>
     struct PolyFIRState : FIRState<Scalar, Length, Channels>
     {
         using Base = FIRState<Scalar, Length, Channels>;
 
-        PolyFIRState() : num_(0)
+        PolyFIRState() : num_(0), correct_num_(0)
         {
             if (Length != Eigen::Dynamic && Channels != Eigen::Dynamic)
                 initialize();
@@ -56,7 +119,11 @@ namespace disiple {
             {
                 Base::buf_.resize(nchans, len);
                 sum_.resize(nchans, coeffs.stages());
-                a_.resize(coeffs.stages());
+                // only allocate what the summation mode uses
+                if (Mode != Plain)
+                    correct_sum_.resize(nchans, coeffs.stages());
+                if (Mode == Compensated)
+                    comp_.resize(nchans);
                 initialize();
             }
         }
@@ -64,7 +131,8 @@ namespace disiple {
         void initialize()
         {
             Base::initialize();
-            sum_.fill(0); num_ = 0; a_.fill(0);
+            sum_.fill(0); correct_sum_.fill(0);
+            num_ = 0;     correct_num_ = static_cast<int>(buf_.cols());
         }
 
         template <int J, int K, typename X>
@@ -76,35 +144,64 @@ namespace disiple {
 
             if (num_ == buf_.cols())
             {
-                // remove oldest sample
-                Scalar n = Scalar(num_);
-                sum_.col(0) -= x_n;
-                for (int i = 1; i < coeffs.stages(); ++i)
-                    sum_.col(i) -= (x_n *= n);
+                // remove oldest sample with its weight in every stage
+                if (Mode == Compensated) {
+                    comp_.add(sum_.col(0), correct_sum_.col(0), -x_n);
+                    for (int i = 1; i < coeffs.stages(); ++i)
+                        comp_.add(sum_.col(i), correct_sum_.col(i), -coeffs.removal_[i] * x_n);
+                } else {
+                    sum_.col(0) -= x_n;
+                    for (int i = 1; i < coeffs.stages(); ++i)
+                        sum_.col(i) -= coeffs.removal_[i] * x_n;
+                }
             }
             else
-            {
-                // re-calculate coefficients
-                Scalar n = Scalar(++num_);
-                coeffs.update(n, a_);
-            }
+                ++num_;
 
             // store new sample
             x_n = xi;
 
             // update state and calculate output
-            xi = a_[0] * (sum_.col(0) += x_n);
+            const auto a = coeffs.weights(num_);
 
-            for (int i = 1; i < coeffs.stages(); ++i)
-                xi += a_[i] * (sum_.col(i) += sum_.col(i-1));
+            if (Mode == Compensated)
+            {
+                comp_.add(sum_.col(0), correct_sum_.col(0), x_n);
+                xi = a[0] * (sum_.col(0) + correct_sum_.col(0));
+
+                for (int i = 1; i < coeffs.stages(); ++i) {
+                    comp_.add(sum_.col(i), correct_sum_.col(i), sum_.col(i-1));
+                    correct_sum_.col(i) += correct_sum_.col(i-1);
+                    xi += a[i] * (sum_.col(i) + correct_sum_.col(i));
+                }
+            }
+            else
+            {
+                xi = a[0] * (sum_.col(0) += x_n);
+                if (Mode == Resync)
+                    correct_sum_.col(0) += x_n;
+
+                for (int i = 1; i < coeffs.stages(); ++i) {
+                    xi += a[i] * (sum_.col(i) += sum_.col(i-1));
+                    if (Mode == Resync)
+                        correct_sum_.col(i) += correct_sum_.col(i-1);
+                }
+
+                if (Mode == Resync && --correct_num_ == 0) {
+                    sum_ = correct_sum_;
+                    correct_sum_.setZero();
+                    correct_num_ = static_cast<int>(buf_.cols());
+                }
+            }
         }
 
         using Base::advance;
         using Base::buf_;
         using Base::pos_;
         Eigen::Array<Scalar, Channels, Stages>      sum_;
-        Eigen::Array<Scalar, Stages, 1>             a_;
-        int                                         num_;
+        Eigen::Array<Scalar, Channels, Stages>      correct_sum_; ///< Resync: shadow sums, Compensated: compensation
+        CompensatedSum<Scalar, Channels>            comp_;
+        int                                         num_, correct_num_;
     };
 
 }
@@ -1,7 +1,15 @@
 #pragma once
 
-#include <deque>
+#include <disiple/impl/filter_base.hpp>
+#include <disiple/impl/fir_impl.hpp>
+#include <disiple/impl/maybe_static.hpp>
 #include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 
 namespace disiple {
 
@@ -16,7 +24,11 @@ namespace disiple {
         RunningMinMaxCoeffs() : len_(0) {}
 
         explicit RunningMinMaxCoeffs(int len)
-        : len_(len) {}
+        : len_(len)
+        {
+            if (len < 1)
+                throw std::invalid_argument("Running min/max: length must be positive");
+        }
 
         static Scalar scaling() { return Scalar(1); }
         int length() const { return len_; }
@@ -24,120 +36,771 @@ namespace disiple {
         int len_;
     };
 
+    /// Lemire's monotonic wedge for every channel, kept in a preallocated
+    /// ring buffer of window length. Values and their absolute sample
+    /// indices are stored in separate channels-by-length arrays, so no
+    /// element has to be touched when time advances.
+    template <typename Scalar, int Channels, template<typename> class Compare>
+    struct MonotonicQueue
+    {
+        void setup(int nchans, int len)
+        {
+            if (vals_.rows() != nchans || vals_.cols() != len)
+            {
+                vals_.resize(nchans, len);
+                idx_.resize(nchans, len);
+                head_.resize(nchans);
+                size_.resize(nchans);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            head_.setZero();
+            size_.setZero();
+        }
+
+        /// Append sample x of channel c, taken at time t
+        void push(int c, long long t, Scalar x)
+        {
+            push(c, t, x, t - vals_.cols() + 1);
+        }
+
+        /// Append sample x of channel c, taken at time t, where the window
+        /// starts at sample first. The capacity must exceed t - first.
+        void push(int c, long long t, Scalar x, long long first)
+        {
+            Compare<Scalar> cmp;
+            const int len = static_cast<int>(vals_.cols());
+            int head = head_[c], size = size_[c];
+
+            // pop the front while it is out of the window
+            while (size > 0 && idx_(c, head) < first) {
+                head = head + 1 == len ? 0 : head + 1;
+                --size;
+            }
+
+            // remove elements from the back that x dominates
+            int back = head + size - 1;
+            if (back >= len) back -= len;
+            while (size > 0 && !cmp(vals_(c, back), x)) {
+                back = back == 0 ? len - 1 : back - 1;
+                --size;
+            }
+
+            if (++back == len) back = 0;
+            vals_(c, back) = x;
+            idx_(c, back)  = t;
+
+            head_[c] = head;
+            size_[c] = size + 1;
+        }
+
+        /// Enlarge the ring buffers, keeping their contents
+        void grow(int len)
+        {
+            Eigen::Array<Scalar,    Channels, Eigen::Dynamic> vals(vals_.rows(), len);
+            Eigen::Array<long long, Channels, Eigen::Dynamic> idx(idx_.rows(), len);
+            const int old = static_cast<int>(vals_.cols());
+            for (int c=0; c<vals_.rows(); ++c)
+                for (int k=0, s=head_[c]; k<size_[c]; ++k, s = s+1 == old ? 0 : s+1) {
+                    vals(c, k) = vals_(c, s);
+                    idx(c, k)  = idx_(c, s);
+                }
+            vals_.swap(vals);
+            idx_.swap(idx);
+            head_.setZero();
+        }
+
+        Scalar    front(int c)       const { return vals_(c, head_[c]); }
+        long long front_index(int c) const { return idx_(c, head_[c]); }
+
+        Eigen::Array<Scalar,    Channels, Eigen::Dynamic> vals_;
+        Eigen::Array<long long, Channels, Eigen::Dynamic> idx_;
+        Eigen::Array<int,       Channels, 1>              head_, size_;
+    };
+
     template <typename Scalar, int Channels, template<typename> class Compare>
     struct RunningMinMaxState
     {
         using Coeffs = RunningMinMaxCoeffs<Scalar>;
 
-        RunningMinMaxState()
+        RunningMinMaxState() : t_(0) {}
+
+        void setup(const Coeffs& coeffs, int nchans)
         {
-            if (Channels != Eigen::Dynamic)
-                initialize();
+            queue_.setup(nchans, coeffs.length());
+        }
+
+        void initialize()
+        {
+            queue_.initialize();
+            t_ = 0;
+        }
+
+        template <typename X>
+        void apply(const Coeffs&, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            for (int c=0; c<xi.size(); ++c)
+                queue_.push(c, t_, xi[c]);
+            ++t_;
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi)
+        {
+            apply(coeffs, xi, dry_run);
+            for (int c=0; c<xi.size(); ++c)
+                xi[c] = queue_.front(c);
+        }
+
+        MonotonicQueue<Scalar, Channels, Compare> queue_;
+        long long t_;
+    };
+
+
+    /// Position of the running minimum or maximum: the output is its lag,
+    /// i.e. how many samples ago it occurred (0 for the newest sample).
+    /// Of equal values, the most recent one is reported.
+    template <typename Scalar, int Channels, template<typename> class Compare>
+    struct RunningArgMinMaxState : RunningMinMaxState<Scalar, Channels, Compare>
+    {
+        using Base   = RunningMinMaxState<Scalar, Channels, Compare>;
+        using Coeffs = RunningMinMaxCoeffs<Scalar>;
+
+        using Base::apply;
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi)
+        {
+            apply(coeffs, xi, dry_run);
+            for (int c=0; c<xi.size(); ++c)
+                xi[c] = static_cast<Scalar>(t_ - 1 - queue_.front_index(c));
+        }
+
+        using Base::queue_;
+        using Base::t_;
+    };
+
+    template <typename Scalar, int Channels>
+    struct RunningRangeState
+    {
+        using Coeffs = RunningMinMaxCoeffs<Scalar>;
+
+        RunningRangeState() : t_(0) {}
+
+        void setup(const Coeffs& coeffs, int nchans)
+        {
+            qmin_.setup(nchans, coeffs.length());
+            qmax_.setup(nchans, coeffs.length());
+        }
+
+        void initialize()
+        {
+            qmin_.initialize();
+            qmax_.initialize();
+            t_ = 0;
+        }
+
+        template <typename X>
+        void apply(const Coeffs&, Eigen::ArrayBase<X>& xi)
+        {
+            // both wedges are updated in a single pass over the channels
+            for (int c=0; c<xi.size(); ++c)
+            {
+                const Scalar x = xi[c];
+                qmin_.push(c, t_, x);
+                qmax_.push(c, t_, x);
+                xi[c] = qmax_.front(c) - qmin_.front(c);
+            }
+            ++t_;
+        }
+
+        template <typename X>
+        void apply(const Coeffs&, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            for (int c=0; c<xi.size(); ++c)
+            {
+                qmin_.push(c, t_, xi[c]);
+                qmax_.push(c, t_, xi[c]);
+            }
+            ++t_;
         }
 
+        MonotonicQueue<Scalar, Channels, std::less>    qmin_;
+        MonotonicQueue<Scalar, Channels, std::greater> qmax_;
+        long long t_;
+    };
+
+
+    /// Running quantile: linear interpolation between the order statistics
+    /// around position q*(n-1) of the n samples in the window, as
+    /// numpy.quantile does. The median is q = 0.5.
+    template <typename Scalar>
+    struct RunningQuantileCoeffs
+    {
+        RunningQuantileCoeffs() : len_(0), q_(0.5) {}
+
+        RunningQuantileCoeffs(int len, double q)
+        : len_(len), q_(q)
+        {
+            if (len < 1)
+                throw std::invalid_argument("Running quantile: length must be positive");
+            if (!(q >= 0 && q <= 1))
+                throw std::invalid_argument("Running quantile: q must be in [0, 1]");
+        }
+
+        static Scalar scaling() { return Scalar(1); }
+        int length()     const { return len_; }
+        double quantile() const { return q_; }
+
+        /// Number of samples up to and including the lower order
+        /// statistic, for a window of n samples
+        int lower_count(int n) const { return n > 0 ? static_cast<int>(std::floor(q_ * (n-1))) + 1 : 0; }
+
+        int    len_;
+        double q_;
+    };
+
+    /// The window of each channel is split into two indexed heaps: a
+    /// max-heap with the lower_count() smallest samples and a min-heap with
+    /// the rest, so the quantile is read off their tops. A new sample
+    /// overwrites the oldest one in place, which costs O(log length) and
+    /// keeps the heap sizes, so nothing is allocated once set up. Every
+    /// channel owns a column of the value ring buffer, of the heaps (the
+    /// max-heap at the front, the min-heap from position lower_count(length)
+    /// on) and of the position of each sample in the heaps.
+    template <typename Scalar, int Channels>
+    struct RunningQuantileState
+    {
+        using Coeffs = RunningQuantileCoeffs<Scalar>;
+
+        RunningQuantileState() : pos_(0), num_(0), split_(0) {}
+
         void setup(const Coeffs& coeffs, int nchans)
         {
-            if (nchans != bufs_.size()) {
-                bufs_.resize(nchans);
+            if (vals_.cols() != nchans || vals_.rows() != coeffs.length())
+            {
+                vals_.resize(coeffs.length(), nchans);
+                heap_.resize(coeffs.length(), nchans);
+                loc_.resize(coeffs.length(), nchans);
+                nlo_.resize(nchans);
+                nhi_.resize(nchans);
+                split_ = coeffs.lower_count(coeffs.length());
                 initialize();
             }
         }
 
         void initialize()
         {
-            for (int i=0; i<bufs_.size(); ++i) {
-                bufs_[i].clear();
-                bufs_[i].emplace_back(std::numeric_limits<size_t>::max(), Scalar(0));
+            nlo_.setZero();
+            nhi_.setZero();
+            pos_ = 0;
+            num_ = 0;
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            const int len = coeffs.length();
+
+            if (num_ < len)
+            {
+                // still filling up, the heaps grow
+                const bool lower_grows = coeffs.lower_count(num_+1) > coeffs.lower_count(num_);
+                for (int c=0; c<xi.size(); ++c)
+                    insert(c, xi[c], lower_grows);
+                ++num_;
             }
+            else
+            {
+                for (int c=0; c<xi.size(); ++c)
+                    replace(c, xi[c]);
+            }
+
+            if (++pos_ == len) pos_ = 0;
         }
 
         template <typename X>
-        void apply(const Coeffs& coeffs,
-                   const Eigen::ArrayBase<X>& xi, DryRun)
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi)
         {
-            //David Lemire, “Streaming Maximum-Minimum Filter
-            //Using No More than Three Comparisons per Element”
-            //Nordic Journal of Computing,  vol. 13, 2006
+            apply(coeffs, xi, dry_run);
 
-            Compare<Scalar> cmp;
+            const double p = coeffs.quantile() * (num_-1);
+            const double frac = p - std::floor(p);
 
-            for (int c=0; c<bufs_.size(); ++c)
+            for (int c=0; c<xi.size(); ++c)
             {
-                auto& buf = bufs_[c];
-                Scalar x = xi[c];
+                const Scalar lo = vals_(heap_(0, c), c);
+                if (frac == 0 || nhi_[c] == 0)
+                    xi[c] = lo;
+                else
+                    xi[c] = static_cast<Scalar>(lo + frac * (vals_(heap_(split_, c), c) - lo));
+            }
+        }
 
-                //pop oldest element
-                if (buf.front().first >= (size_t)coeffs.length())
-                    buf.pop_front();
+    private:
+        // the lower heap is a max-heap at offset 0, the upper a min-heap at split_
+        bool before(int c, bool upper, int a, int b) const
+        {
+            return upper ? vals_(a, c) < vals_(b, c) : vals_(a, c) > vals_(b, c);
+        }
 
-                //remove greater elements from back
-                while (!buf.empty() && !cmp(buf.back().second, x))
-                    buf.pop_back();
+        void put(int c, int at, int slot)
+        {
+            heap_(at, c) = slot;
+            loc_(slot, c) = at;
+        }
 
-                //increase ages of all remaining elements
-                for (auto& p : buf) ++p.first;
+        void swap_nodes(int c, int a, int b)
+        {
+            const int sa = heap_(a, c), sb = heap_(b, c);
+            put(c, a, sb);
+            put(c, b, sa);
+        }
+
+        void sift_up(int c, bool upper, int j)
+        {
+            const int base = upper ? split_ : 0;
+            while (j > 0)
+            {
+                const int parent = (j-1) / 2;
+                if (!before(c, upper, heap_(base+j, c), heap_(base+parent, c)))
+                    break;
+                swap_nodes(c, base+j, base+parent);
+                j = parent;
+            }
+        }
+
+        void sift_down(int c, bool upper, int j)
+        {
+            const int base = upper ? split_ : 0, size = upper ? nhi_[c] : nlo_[c];
+            for (;;)
+            {
+                int best = 2*j + 1;
+                if (best >= size)
+                    break;
+                if (best+1 < size && before(c, upper, heap_(base+best+1, c), heap_(base+best, c)))
+                    ++best;
+                if (!before(c, upper, heap_(base+best, c), heap_(base+j, c)))
+                    break;
+                swap_nodes(c, base+j, base+best);
+                j = best;
+            }
+        }
+
+        void push(int c, bool upper, int slot)
+        {
+            int& size = upper ? nhi_[c] : nlo_[c];
+            put(c, (upper ? split_ : 0) + size, slot);
+            sift_up(c, upper, size++);
+        }
+
+        int pop(int c, bool upper)
+        {
+            const int base = upper ? split_ : 0;
+            int& size = upper ? nhi_[c] : nlo_[c];
+            const int top = heap_(base, c);
+            if (--size > 0)
+            {
+                put(c, base, heap_(base+size, c));
+                sift_down(c, upper, 0);
+            }
+            return top;
+        }
 
-                buf.emplace_back(1, x);
+        Scalar top(int c, bool upper) const { return vals_(heap_(upper ? split_ : 0, c), c); }
+
+        void insert(int c, Scalar x, bool lower_grows)
+        {
+            vals_(pos_, c) = x;
+
+            // move one sample across if x belongs to the heap that must not grow
+            if (lower_grows)
+            {
+                if (nhi_[c] > 0 && x > top(c, true)) {
+                    push(c, false, pop(c, true));
+                    push(c, true, pos_);
+                } else
+                    push(c, false, pos_);
+            }
+            else
+            {
+                if (x < top(c, false)) {
+                    push(c, true, pop(c, false));
+                    push(c, false, pos_);
+                } else
+                    push(c, true, pos_);
             }
         }
 
-        template <typename F, typename Dst>
-        void process_result(F f, Eigen::ArrayBase<Dst>& dst) const
+        void replace(int c, Scalar x)
         {
-            for (int i=0; i<bufs_.size(); ++i)
-                f(bufs_[i].front().second, dst[i]);
+            vals_(pos_, c) = x;
+
+            const int at = loc_(pos_, c);
+            const bool upper = at >= split_;
+            const int j = at - (upper ? split_ : 0);
+            sift_up(c, upper, j);
+            sift_down(c, upper, j);
+
+            // at most the new sample is on the wrong side
+            if (nhi_[c] > 0 && top(c, false) > top(c, true))
+            {
+                swap_nodes(c, 0, split_);
+                sift_down(c, false, 0);
+                sift_down(c, true, 0);
+            }
+        }
+
+        Eigen::Array<Scalar, Eigen::Dynamic, Channels> vals_;  // ring buffer of samples
+        Eigen::Array<int,    Eigen::Dynamic, Channels> heap_;  // heap node -> slot
+        Eigen::Array<int,    Eigen::Dynamic, Channels> loc_;   // slot -> heap node
+        Eigen::Array<int,    Channels, 1>              nlo_, nhi_;
+        int pos_, num_, split_;
+    };
+
+
+    /// Which statistic a sliding second-moment filter outputs
+    enum class RunningMoment
+    {
+        Variance,  ///< Population variance of the window
+        Std,       ///< Its square root
+        ZScore     ///< Deviation of the newest sample from the mean, in standard deviations
+    };
+
+    template <typename Scalar, int Length>
+    struct RunningMomentCoeffs
+    : private MaybeStatic<Length, void>  // inheritance enables empty base-class optimization
+    {
+        /// A window of Length or, if dynamic, 1 sample
+        RunningMomentCoeffs() : MaybeStatic<Length, void>(Length == Eigen::Dynamic ? 1 : Length) {}
+
+        explicit RunningMomentCoeffs(int n)
+        : MaybeStatic<Length, void>(n)
+        {
+            if (n < 1)
+                throw std::invalid_argument("Running variance: length must be positive");
+        }
+
+        int length() const { return MaybeStatic<Length, void>::get(); }
+    };
+
+    /// Windowed mean and sum of squared deviations, updated per sample by
+    /// Welford's rule for replacing the oldest sample with the newest. The
+    /// rounding errors this accumulates are discarded every Length samples,
+    /// when both are recomputed from the history (O(1) amortized).
+    template <typename Scalar, int Length, int Channels, RunningMoment Output>
+    struct RunningMomentState : FIRState<Scalar, Length, Channels>
+    {
+        static_assert(std::is_floating_point<Scalar>::value,
+                      "Running variance needs a floating point Scalar");
+
+        using Base   = FIRState<Scalar, Length, Channels>;
+        using Coeffs = RunningMomentCoeffs<Scalar, Length>;
+
+        RunningMomentState() : num_(0), resync_num_(0)
+        {
+            if (Length != Eigen::Dynamic && Channels != Eigen::Dynamic)
+                initialize();
+        }
+
+        void setup(const Coeffs& coeffs, int nchans)
+        {
+            if (Base::num_chans() != nchans || Base::length() != coeffs.length())
+            {
+                buf_.resize(nchans, coeffs.length());
+                mean_.resize(nchans); m2_.resize(nchans);
+                delta_.resize(nchans); prev_.resize(nchans);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            Base::initialize();
+            mean_.setZero(); m2_.setZero();
+            num_ = 0;        resync_num_ = static_cast<int>(buf_.cols());
         }
 
         template <typename X>
-        void apply(const Coeffs& coeffs,
-                   Eigen::ArrayBase<X>& xi)
+        void apply(const Coeffs&, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            advance();
+
+            if (num_ == buf_.cols())
+            {
+                // x_old leaves, x enters
+                const Scalar n = Scalar(num_);
+                delta_ = xi - buf_.col(pos_).array();
+                prev_  = mean_;
+                mean_ += delta_ / n;
+                m2_   += delta_ * ((xi - mean_) + (buf_.col(pos_).array() - prev_));
+                m2_    = m2_.max(Scalar(0));
+            }
+            else
+            {
+                const Scalar n = Scalar(++num_);
+                delta_ = xi - mean_;
+                mean_ += delta_ / n;
+                m2_   += delta_ * (xi - mean_);
+            }
+
+            buf_.col(pos_) = xi.matrix();
+
+            if (--resync_num_ == 0)
+            {
+                mean_ = buf_.array().rowwise().mean();
+                m2_   = (buf_.array().colwise() - mean_).square().rowwise().sum();
+                resync_num_ = static_cast<int>(buf_.cols());
+            }
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi)
         {
             apply(coeffs, xi, dry_run);
-            process_result([] (Scalar src, Scalar& dst) { dst = src; }, xi);
+
+            // the mean of a constant window can be a few ulps off, which
+            // leaves m2_ slightly positive: spreads at the rounding level of
+            // the mean count as zero
+            const Scalar n = Scalar(num_);
+            const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+            delta_ = (m2_ <= n * eps * mean_.square()).select(Scalar(0), m2_);
+
+            switch (Output)
+            {
+            case RunningMoment::Variance:
+                xi = delta_ / n;
+                break;
+            case RunningMoment::Std:
+                xi = (delta_ / n).sqrt();
+                break;
+            case RunningMoment::ZScore:
+                xi = (delta_ > Scalar(0)).select((xi - mean_) / (delta_ / n).sqrt(), Scalar(0));
+                break;
+            }
         }
 
-        using buf_t = std::deque<std::pair<size_t, Scalar>>;
-        Eigen::Array<buf_t, Channels, 1> bufs_;
-        int length_;
+        using Base::advance;
+        using Base::buf_;
+        using Base::pos_;
+        Eigen::Array<Scalar, Channels, 1> mean_, m2_;
+        Eigen::Array<Scalar, Channels, 1> delta_, prev_;  // scratch
+        int num_, resync_num_;
     };
 
 
+    /// Fixed bins of equal width covering [lower, upper), plus one bin each
+    /// for the samples below and above
+    struct HistogramCoeffs
+    {
+        HistogramCoeffs(double lower, double upper, int bins)
+        : lower_(lower), upper_(upper), bins_(bins)
+        {
+            if (!(lower < upper) || bins < 1)
+                throw std::invalid_argument("Histogram: need lower < upper and at least one bin");
+        }
+
+        double lower() const { return lower_; }
+        double upper() const { return upper_; }
+        int    bins()  const { return bins_; }
+        double width() const { return (upper_ - lower_) / bins_; }
+
+        bool operator==(const HistogramCoeffs& o) const
+        {
+            return lower_ == o.lower_ && upper_ == o.upper_ && bins_ == o.bins_;
+        }
+
+        double lower_, upper_;
+        int bins_;
+    };
+
+    /// Histogram of all samples so far, with the exact minimum and
+    /// maximum of every channel. Memory is fixed by the number of bins.
     template <typename Scalar, int Channels>
-    struct RunningRangeState
+    struct HistogramState
     {
-        using Coeffs = RunningMinMaxCoeffs<Scalar>;
+        using Coeffs = HistogramCoeffs;
+        using Counts = Eigen::Array<long long, Eigen::Dynamic, Channels>;
+
+        enum { Chunk = 256 };  ///< Columns binned at once
+
+        HistogramState() { num_.setZero(); }
 
         void setup(const Coeffs& coeffs, int nchans)
         {
-            smin.setup(coeffs, nchans);
-            smax.setup(coeffs, nchans);
+            if (counts_.cols() != nchans || counts_.rows() != coeffs.bins() + 2)
+            {
+                counts_.resize(coeffs.bins() + 2, nchans);
+                num_.resize(nchans);
+                min_.resize(nchans);
+                max_.resize(nchans);
+                pos_.resize(nchans, Chunk);
+                initialize();
+            }
         }
 
         void initialize()
         {
-            smin.initialize();
-            smax.initialize();
+            counts_.setZero();
+            num_.setZero();
+            min_.setConstant( std::numeric_limits<double>::infinity());
+            max_.setConstant(-std::numeric_limits<double>::infinity());
         }
 
+        /// Add a block, channels-by-time. NaNs are skipped.
         template <typename X>
-        void apply(const Coeffs& coeffs,
-                   Eigen::ArrayBase<X>& xi)
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& x)
         {
-            smin.apply(coeffs, xi, dry_run);
-            smax.apply(coeffs, xi);
-            smin.process_result([] (Scalar src, Scalar& dst) { dst -= src; }, xi);
+            // bin positions of a chunk of columns at once, vectorized; the
+            // scratch has a fixed size however long the block is
+            const int bins = coeffs.bins();
+            for (Eigen::Index t0 = 0; t0 < x.cols(); t0 += Chunk)
+            {
+                const Eigen::Index n = std::min<Eigen::Index>(Chunk, x.cols() - t0);
+                auto pos = pos_.leftCols(n);
+                pos = (x.middleCols(t0, n).template cast<double>() - coeffs.lower()) * (1 / coeffs.width());
+
+                for (Eigen::Index t = 0; t < n; ++t)
+                    for (Eigen::Index c = 0; c < x.rows(); ++c)
+                    {
+                        const double p = pos(c, t);
+                        if (p != p)
+                            continue;
+                        const int b = p < 0 ? 0 : p >= bins ? bins + 1 : static_cast<int>(p) + 1;
+                        ++counts_(b, c);
+                        ++num_[c];
+
+                        const double v = static_cast<double>(x(c, t0 + t));
+                        min_[c] = std::min(min_[c], v);
+                        max_[c] = std::max(max_[c], v);
+                    }
+            }
         }
 
-        template <typename X>
-        void apply(const Coeffs& coeffs,
-                   const Eigen::ArrayBase<X>& xi, DryRun)
+        void merge(const HistogramState& o)
+        {
+            counts_ += o.counts_;
+            num_    += o.num_;
+            min_     = min_.min(o.min_);
+            max_     = max_.max(o.max_);
+        }
+
+        /// Quantile q of channel c, interpolated as numpy.quantile would,
+        /// assuming the samples are spread evenly within each bin. The
+        /// error is at most one bin width for quantiles in [lower, upper).
+        double quantile(const Coeffs& coeffs, int c, double q) const
         {
-            smin.apply(coeffs, xi, dry_run);
-            smax.apply(coeffs, xi, dry_run);
+            if (num_[c] == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            // the extremes are known exactly
+            const double rank = q * (num_[c] - 1);
+            if (rank <= 0)           return min_[c];
+            if (rank >= num_[c] - 1) return max_[c];
+
+            long long below = 0;
+            int b = 0;
+            while (below + counts_(b, c) <= rank)
+                below += counts_(b++, c);
+
+            // edges of the bin, the outer bins end at the extremes
+            const double lo = b == 0 ? min_[c] : coeffs.lower() + (b-1) * coeffs.width();
+            const double hi = b == coeffs.bins() + 1 ? max_[c] : coeffs.lower() + b * coeffs.width();
+            const double v  = lo + (rank - below + 0.5) / counts_(b, c) * (hi - lo);
+            return std::max(min_[c], std::min(max_[c], v));
         }
 
-        RunningMinMaxState<Scalar, Channels, std::less>    smin;
-        RunningMinMaxState<Scalar, Channels, std::greater> smax;
+        Counts counts_;
+        Eigen::Array<long long, Channels, 1> num_;
+        Eigen::Array<double, Channels, 1>    min_, max_;
+        Eigen::Array<double, Channels, Eigen::Dynamic> pos_;  // scratch, channels-by-Chunk
     };
 
+
+    namespace internal {
+        /// Running minimum and/or maximum of a whole channels-by-time block by
+        /// the van Herk/Gil-Werman algorithm. Time is cut into segments of the
+        /// window length; every window is covered by the suffix of one segment
+        /// and the prefix of the next, so each sample costs three comparisons
+        /// whatever the length. All operations are on whole columns and thus
+        /// vectorized across channels. The result is the same as that of the
+        /// streaming filter starting from its initial state, and y may alias x.
+        template <bool Min, bool Max, typename X, typename Y>
+        void block_min_max(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>& y)
+        {
+            using Scalar = typename Y::Scalar;
+            using Block  = Eigen::Array<Scalar, X::RowsAtCompileTime, Eigen::Dynamic>;
+            using Vec    = Eigen::Array<Scalar, X::RowsAtCompileTime, 1>;
+
+            if (len < 1)
+                throw std::invalid_argument("Running min/max: length must be positive");
+            if (y.rows() != x.rows() || y.cols() != x.cols())
+                throw std::invalid_argument("Running min/max: output size must match input size");
+
+            const Eigen::Index n = x.cols(), seg = std::min<Eigen::Index>(len, n);
+
+            // suffix extrema of the previous and the current segment
+            Block prev_min, prev_max, cur_min, cur_max;
+            if (seg < n) {
+                if (Min) { prev_min.resize(x.rows(), seg); cur_min.resize(x.rows(), seg); }
+                if (Max) { prev_max.resize(x.rows(), seg); cur_max.resize(x.rows(), seg); }
+            }
+
+            Vec pmin, pmax, omin, omax;
+
+            for (Eigen::Index s = 0; s < n; s += seg)
+            {
+                const Eigen::Index m = std::min(seg, n - s);
+
+                // the suffixes are needed by the next segment and must be
+                // taken before y overwrites x
+                if (s + m < n)
+                {
+                    if (Min) cur_min.col(m-1) = x.col(s+m-1).template cast<Scalar>();
+                    if (Max) cur_max.col(m-1) = x.col(s+m-1).template cast<Scalar>();
+                    for (Eigen::Index i = m-2; i >= 0; --i)
+                    {
+                        if (Min) cur_min.col(i) = cur_min.col(i+1).min(x.col(s+i).template cast<Scalar>());
+                        if (Max) cur_max.col(i) = cur_max.col(i+1).max(x.col(s+i).template cast<Scalar>());
+                    }
+                }
+
+                for (Eigen::Index k = 0; k < m; ++k)
+                {
+                    const auto xt = x.col(s+k).template cast<Scalar>();
+
+                    if (k == 0) {
+                        if (Min) pmin = xt;
+                        if (Max) pmax = xt;
+                    } else {
+                        if (Min) pmin = pmin.min(xt);
+                        if (Max) pmax = pmax.max(xt);
+                    }
+
+                    // the window starts in the previous segment unless it
+                    // coincides with the current one
+                    const bool split = s > 0 && k+1 < seg;
+                    if (split) {
+                        if (Min) omin = prev_min.col(k+1).min(pmin);
+                        if (Max) omax = prev_max.col(k+1).max(pmax);
+                    } else {
+                        if (Min) omin = pmin;
+                        if (Max) omax = pmax;
+                    }
+
+                    if (Min && Max) y.col(s+k) = omax - omin;
+                    else if (Min)   y.col(s+k) = omin;
+                    else            y.col(s+k) = omax;
+                }
+
+                prev_min.swap(cur_min);
+                prev_max.swap(cur_max);
+            }
+        }
+
+    }
+
 }
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <disiple/impl/fir_impl.hpp>
+#include <disiple/impl/maybe_static.hpp>
+#include <disiple/impl/pole_zero_pair.hpp>
+#include <Eigen/Core>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace disiple {
+
+    // sliding dft of a few, arbitrary frequencies
+
+    template <typename Scalar, int Length>
+    struct SlidingDFTCoeffs : private MaybeStatic<Length>
+    {
+        using Complex = std::complex<Scalar>;
+        using Bins    = Eigen::Array<Complex, Eigen::Dynamic, 1>;
+
+        SlidingDFTCoeffs() : MaybeStatic<Length>(Length == Eigen::Dynamic ? 1 : Length), hop_(1) {}
+
+        /// The dft of the last n samples, tapered with r^age, at each of
+        /// the frequencies w_k = freqs[k] * pi:
+        ///     S_k[n] = sum_m r^(n-m) x[m] exp(-i w_k (m-n+N-1)),  n-N < m <= n
+        /// is updated recursively:
+        ///     S_k[n] = r e^(i w_k) (S_k[n-1] - r^(N-1) x[n-N]) + e^(-i w_k (N-1)) x[n]
+        SlidingDFTCoeffs(int n, const std::vector<double>& freqs, int hop, double r)
+        : MaybeStatic<Length>(n), hop_(hop)
+        {
+            if (n < 1)
+                throw std::invalid_argument("Sliding DFT length must be positive");
+            if (hop < 1)
+                throw std::invalid_argument("Sliding DFT hop must be positive");
+            if (r <= 0.0 || r > 1.0)
+                throw std::invalid_argument("Sliding DFT damping must be in (0,1]");
+
+            const int k = static_cast<int>(freqs.size());
+            a_.resize(k); b_.resize(k); c_.resize(k); ss_.resize(k); scale_.resize(k);
+
+            // sum of the taper, the gain of a component at frequency 0
+            const double rn = std::pow(r, n);
+            const double gain = r < 1.0 ? (1.0 - rn) / (1.0 - r) : double(n);
+
+            for (int i = 0; i < k; ++i)
+            {
+                if (freqs[i] < 0.0 || freqs[i] > 1.0)
+                    throw std::invalid_argument("Frequencies must be in [0,1]");
+
+                const double w = freqs[i] * pi;
+                const std::complex<double> e = std::polar(1.0, w);
+                a_[i] = Complex(r * e);
+                b_[i] = Complex(-rn * e);
+                c_[i] = Complex(std::polar(1.0, -w * (n - 1)));
+
+                // response to a constant input
+                std::complex<double> s = 0;
+                for (int m = 0; m < n; ++m)
+                    s += std::pow(r, n - 1 - m) * std::polar(1.0, -w * m);
+                ss_[i] = Complex(s);
+
+                // a sinusoid of amplitude A gives |S| = A/2 * gain,
+                // except at DC and Nyquist
+                const bool edge = freqs[i] == 0.0 || freqs[i] == 1.0;
+                scale_[i] = Scalar((edge ? 1.0 : 2.0) / gain);
+            }
+        }
+
+        int length()   const { return MaybeStatic<Length>::get(); }
+        int num_bins() const { return static_cast<int>(a_.size()); }
+
+        Bins a_, b_, c_, ss_;
+        Eigen::Array<Scalar, Eigen::Dynamic, 1> scale_;
+        int hop_;
+    };
+
+    template <typename Scalar, int Length, int Channels>
+    struct SlidingDFTState : FIRState<Scalar, Length, Channels>
+    {
+        using Base    = FIRState<Scalar, Length, Channels>;
+        using Coeffs  = SlidingDFTCoeffs<Scalar, Length>;
+        using Complex = std::complex<Scalar>;
+
+        SlidingDFTState() : Base(), count_(0) {}
+
+        using Base::advance;
+
+        void setup(const Coeffs& coeffs, int nchans)
+        {
+            const bool changed = Base::num_chans() != nchans || Base::length() != coeffs.length()
+                              || s_.cols() != coeffs.num_bins();
+            Base::setup(coeffs, nchans);
+            if (changed)
+            {
+                s_.resize(nchans, coeffs.num_bins());
+                amp_.resize(nchans, coeffs.num_bins());
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            Base::initialize();
+            s_.setZero();
+            amp_.setZero();
+            count_ = 0;
+        }
+
+        template <typename X>
+        void initialize(const Coeffs& coeffs, const Eigen::ArrayBase<X>& x_ss)
+        {
+            buf_ = x_ss.matrix().replicate(1, buf_.cols());
+            for (int k = 0; k < s_.cols(); ++k)
+                s_.col(k) = coeffs.ss_[k] * x_ss.template cast<Complex>();
+            update_amplitudes(coeffs);
+            count_ = 0;
+        }
+
+        /// @param yi Output, the amplitudes of all bins stacked:
+        ///           row k*channels+c holds bin k of channel c
+        template <typename X, typename Y>
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi, Eigen::ArrayBase<Y>& yi)
+        {
+            update(coeffs, xi);
+
+            if (++count_ >= coeffs.hop_)
+            {
+                update_amplitudes(coeffs);
+                count_ = 0;
+            }
+
+            const int nchans = static_cast<int>(amp_.rows());
+            for (int k = 0; k < amp_.cols(); ++k)
+                yi.segment(k * nchans, nchans) = amp_.col(k);
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi, DryRun)
+        {
+            update(coeffs, xi);
+        }
+
+        template <typename X>
+        void update(const Coeffs& coeffs, const Eigen::ArrayBase<X>& xi)
+        {
+            advance();
+            auto xN = buf_.col(pos_).array();
+
+            // vectorized across channels
+            for (int k = 0; k < s_.cols(); ++k)
+                s_.col(k) = coeffs.a_[k] * s_.col(k)
+                          + coeffs.b_[k] * xN.template cast<Complex>()
+                          + coeffs.c_[k] * xi.template cast<Complex>();
+
+            xN = xi;
+        }
+
+        void update_amplitudes(const Coeffs& coeffs)
+        {
+            amp_ = s_.abs().rowwise() * coeffs.scale_.transpose();
+        }
+
+        Eigen::Array<Complex, Channels, Eigen::Dynamic> s_;
+        Eigen::Array<Scalar,  Channels, Eigen::Dynamic> amp_;
+        int count_;
+        using Base::buf_;
+        using Base::pos_;
+    };
+
+}
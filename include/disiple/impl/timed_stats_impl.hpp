@@ -0,0 +1,280 @@
+#pragma once
+
+#include <disiple/impl/running_stats_impl.hpp>
+#include <Eigen/Core>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace disiple {
+
+    /// Window covering the samples taken within the last horizon, i.e. at
+    /// times in (t - horizon, t] for the newest sample taken at t
+    struct TimedWindowCoeffs
+    {
+        explicit TimedWindowCoeffs(double horizon)
+        : horizon_(horizon)
+        {
+            if (!(horizon > 0))
+                throw std::invalid_argument("Timed window: horizon must be positive");
+        }
+
+        double horizon() const { return horizon_; }
+
+        double horizon_;
+    };
+
+    /// Timestamps of the samples in a timed window, oldest first, in a ring
+    /// buffer that doubles whenever it is full, so its capacity settles at
+    /// the largest number of samples a window has held.
+    struct TimedWindow
+    {
+        TimedWindow() { initialize(); }
+
+        void initialize()
+        {
+            head_ = 0; size_ = 0; next_ = 0;
+            last_ = -std::numeric_limits<double>::infinity();
+        }
+
+        int capacity() const { return static_cast<int>(times_.size()); }
+        int size()     const { return size_; }
+        bool full()    const { return size_ == capacity(); }
+
+        /// Absolute index of the oldest sample in the window
+        long long first() const { return next_ - size_; }
+
+        /// Slot of the k-th oldest sample
+        int slot(int k) const
+        {
+            const int s = head_ + k;
+            return s >= capacity() ? s - capacity() : s;
+        }
+
+        /// Drop the samples that are out of the window once a sample taken
+        /// at t arrives, calling f(slot) for each
+        template <typename F>
+        void expire(double t, double horizon, F&& f)
+        {
+            if (!(t >= last_))
+                throw std::invalid_argument("Timed window: timestamps must not decrease");
+            last_ = t;
+
+            while (size_ > 0 && times_[head_] <= t - horizon) {
+                f(head_);
+                head_ = slot(1);
+                --size_;
+            }
+        }
+
+        /// Reorder the columns of a buffer that shares the slots, oldest
+        /// first, into a buffer of the given capacity
+        template <typename A>
+        void unroll(A& a, int capacity) const
+        {
+            A b(a.rows(), capacity);
+            for (int k = 0; k < size_; ++k)
+                b.col(k) = a.col(slot(k));
+            a.swap(b);
+        }
+
+        /// Double the capacity; buffers sharing the slots must be unrolled
+        /// to the new capacity before
+        void grow()
+        {
+            Eigen::ArrayXd t(std::max(16, 2 * capacity()));
+            for (int k = 0; k < size_; ++k)
+                t[k] = times_[slot(k)];
+            times_.swap(t);
+            head_ = 0;
+        }
+
+        /// Append a sample taken at t, there must be room
+        /// @return Its slot
+        int push(double t)
+        {
+            const int s = slot(size_);
+            times_[s] = t;
+            ++size_;
+            ++next_;
+            return s;
+        }
+
+        Eigen::ArrayXd times_;
+        int head_, size_;
+        long long next_;   // absolute index of the next sample
+        double last_;
+    };
+
+    /// Running minimum or maximum over a timed window, with Lemire's wedge
+    /// evicting by absolute sample index
+    template <typename Scalar, int Channels, template<typename> class Compare>
+    struct TimedMinMaxState
+    {
+        using Coeffs = TimedWindowCoeffs;
+
+        void setup(const Coeffs&, int nchans)
+        {
+            if (queue_.vals_.rows() != nchans || window_.capacity() == 0)
+            {
+                window_.times_.resize(16);
+                queue_.setup(nchans, 16);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            window_.initialize();
+            queue_.initialize();
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi, double t)
+        {
+            window_.expire(t, coeffs.horizon(), [] (int) {});
+            if (window_.full()) {
+                window_.grow();
+                queue_.grow(window_.capacity());
+            }
+
+            const long long i = window_.next_;
+            window_.push(t);
+
+            for (int c=0; c<xi.size(); ++c)
+            {
+                queue_.push(c, i, xi[c], window_.first());
+                xi[c] = queue_.front(c);
+            }
+        }
+
+        TimedWindow window_;
+        MonotonicQueue<Scalar, Channels, Compare> queue_;
+    };
+
+    /// Running mean over a timed window. The running sum is recomputed
+    /// from the buffered samples whenever as many samples have arrived as
+    /// the window holds, which keeps rounding errors from accumulating at
+    /// O(1) amortized cost.
+    template <typename Scalar, int Channels>
+    struct TimedMeanState
+    {
+        using Coeffs = TimedWindowCoeffs;
+
+        TimedMeanState() : since_sync_(0) {}
+
+        void setup(const Coeffs&, int nchans)
+        {
+            if (vals_.rows() != nchans || window_.capacity() == 0)
+            {
+                window_.times_.resize(16);
+                vals_.resize(nchans, 16);
+                sum_.resize(nchans);
+                initialize();
+            }
+        }
+
+        void initialize()
+        {
+            window_.initialize();
+            sum_.setZero();
+            since_sync_ = 0;
+        }
+
+        template <typename X>
+        void apply(const Coeffs& coeffs, Eigen::ArrayBase<X>& xi, double t)
+        {
+            window_.expire(t, coeffs.horizon(), [this] (int s) { sum_ -= vals_.col(s); });
+            if (window_.full()) {
+                window_.unroll(vals_, std::max(16, 2 * window_.capacity()));
+                window_.grow();
+            }
+
+            const int s = window_.push(t);
+            vals_.col(s) = xi;
+            sum_ += xi;
+
+            if (++since_sync_ >= window_.size())
+            {
+                sum_.setZero();
+                for (int k = 0; k < window_.size(); ++k)
+                    sum_ += vals_.col(window_.slot(k));
+                since_sync_ = 0;
+            }
+
+            xi = sum_ / Scalar(window_.size());
+        }
+
+        TimedWindow window_;
+        Eigen::Array<Scalar, Channels, Eigen::Dynamic> vals_;
+        Eigen::Array<Scalar, Channels, 1>              sum_;
+        int since_sync_;
+    };
+
+    /// Like FilterBase, for filters that take a timestamp with every sample
+    template <typename Scalar, typename Derived>
+    class TimedFilterBase
+    {
+        static_assert(std::is_arithmetic<Scalar>::value,
+                      "Scalar must be an arithmetic value");
+
+    public:
+        auto&       state()        { return static_cast<Derived*>(this)->state_; }
+        const auto& state() const  { return static_cast<Derived const*>(this)->state_; }
+
+        auto&       coeffs()       { return static_cast<Derived*>(this)->coeffs_; }
+        const auto& coeffs() const { return static_cast<Derived const*>(this)->coeffs_; }
+
+        /// Discard all samples
+        void initialize() { state().initialize(); }
+
+        double horizon() const { return coeffs().horizon(); }
+
+        /// Apply filter in-place
+        /// @param x Input array, channels-by-time
+        /// @param t Non-decreasing timestamps, one per column of x
+        template <typename X, typename T>
+        void apply(Eigen::ArrayBase<X>& x, const Eigen::DenseBase<T>& t)
+        {
+            check_times(x.cols(), t.size());
+            state().setup(coeffs(), static_cast<int>(x.rows()));
+            for (Eigen::DenseIndex i=0; i<x.cols(); ++i)
+            {
+                auto xi = x.col(i);
+                state().apply(coeffs(), xi, static_cast<double>(t(i)));
+            }
+        }
+
+        template <typename X, typename T>
+        void apply(Eigen::ArrayBase<X>&& x, const Eigen::DenseBase<T>& t) { apply(x, t); }
+
+        /// Apply filter to x and write result to y
+        /// @param x Input array, channels-by-time
+        /// @param t Non-decreasing timestamps, one per column of x
+        /// @param y Output array, channels-by-time
+        template <typename X, typename T, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, const Eigen::DenseBase<T>& t, Eigen::ArrayBase<Y>& y)
+        {
+            check_times(x.cols(), t.size());
+            state().setup(coeffs(), static_cast<int>(x.rows()));
+            for (Eigen::DenseIndex i=0; i<x.cols(); ++i)
+            {
+                auto xi = x.col(i);
+                auto yi = y.col(i);
+                state().apply(coeffs(), yi = xi, static_cast<double>(t(i)));
+            }
+        }
+
+        template <typename X, typename T, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, const Eigen::DenseBase<T>& t, Eigen::ArrayBase<Y>&& y) { apply(x, t, y); }
+
+    private:
+        static void check_times(Eigen::DenseIndex cols, Eigen::DenseIndex times)
+        {
+            if (cols != times)
+                throw std::invalid_argument("Timed filter: need one timestamp per column");
+        }
+    };
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <disiple/impl/filter_base.hpp>
+#include <disiple/impl/morphology_impl.hpp>
+#include <disiple/named_params.hpp>
+
+namespace disiple {
+
+    /// Streaming grayscale morphology with a flat structuring element of
+    /// odd length len. The filters are causal: the output at time t is the
+    /// centered result for sample t - delay(). Near the start of the data,
+    /// the structuring element is clipped to the samples seen so far.
+    /// Opening removes peaks narrower than len, closing fills valleys; the
+    /// closing of the opening (OpenClose) with a wide element estimates the
+    /// baseline of e.g. an ECG.
+
+    /// Erosion, the minimum over the structuring element; delay (len-1)/2
+    template <typename Scalar, typename... Options>
+    class Erosion : public FilterBase<Scalar, Erosion<Scalar, Options...>>,
+                    public Parameters<
+                        List<Options...>,
+                        OptionalValue<int, Channels, 1>
+                    >
+    {
+    public:
+        using State  = MorphologyState<Scalar, Erosion::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit Erosion(int len) : coeffs_(len, { MorphologyOp::Erode }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, Erosion<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Dilation, the maximum over the structuring element; delay (len-1)/2
+    template <typename Scalar, typename... Options>
+    class Dilation : public FilterBase<Scalar, Dilation<Scalar, Options...>>,
+                     public Parameters<
+                        List<Options...>,
+                        OptionalValue<int, Channels, 1>
+                    >
+    {
+    public:
+        using State  = MorphologyState<Scalar, Dilation::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit Dilation(int len) : coeffs_(len, { MorphologyOp::Dilate }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, Dilation<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Opening, the dilation of the erosion; delay len-1
+    template <typename Scalar, typename... Options>
+    class Opening : public FilterBase<Scalar, Opening<Scalar, Options...>>,
+                    public Parameters<
+                        List<Options...>,
+                        OptionalValue<int, Channels, 1>
+                    >
+    {
+    public:
+        using State  = MorphologyState<Scalar, Opening::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit Opening(int len) : coeffs_(len, { MorphologyOp::Erode, MorphologyOp::Dilate }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, Opening<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Closing, the erosion of the dilation; delay len-1
+    template <typename Scalar, typename... Options>
+    class Closing : public FilterBase<Scalar, Closing<Scalar, Options...>>,
+                    public Parameters<
+                        List<Options...>,
+                        OptionalValue<int, Channels, 1>
+                    >
+    {
+    public:
+        using State  = MorphologyState<Scalar, Closing::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit Closing(int len) : coeffs_(len, { MorphologyOp::Dilate, MorphologyOp::Erode }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, Closing<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Open-close, the closing of the opening; delay 2*(len-1)
+    template <typename Scalar, typename... Options>
+    class OpenClose : public FilterBase<Scalar, OpenClose<Scalar, Options...>>,
+                      public Parameters<
+                          List<Options...>,
+                          OptionalValue<int, Channels, 1>
+                      >
+    {
+    public:
+        using State  = MorphologyState<Scalar, OpenClose::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit OpenClose(int len)
+        : coeffs_(len, { MorphologyOp::Erode, MorphologyOp::Dilate, MorphologyOp::Dilate, MorphologyOp::Erode }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, OpenClose<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Close-open, the opening of the closing; delay 2*(len-1)
+    template <typename Scalar, typename... Options>
+    class CloseOpen : public FilterBase<Scalar, CloseOpen<Scalar, Options...>>,
+                      public Parameters<
+                          List<Options...>,
+                          OptionalValue<int, Channels, 1>
+                      >
+    {
+    public:
+        using State  = MorphologyState<Scalar, CloseOpen::channels>;
+        using Coeffs = MorphologyCoeffs<Scalar>;
+
+        explicit CloseOpen(int len)
+        : coeffs_(len, { MorphologyOp::Dilate, MorphologyOp::Erode, MorphologyOp::Erode, MorphologyOp::Dilate }) {}
+
+        int delay() const { return coeffs_.delay(); }
+
+    private:
+        friend FilterBase<Scalar, CloseOpen<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+}
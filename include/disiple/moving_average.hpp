@@ -6,17 +6,22 @@
 
 namespace disiple {
 
+    /// Moving average over the last Length samples, optionally applied
+    /// Stages times. The Summation option chooses how the running sums
+    /// are protected against accumulating rounding errors.
     template <typename Scalar, typename... Options>
     class MovingAverage : public FilterBase<Scalar, MovingAverage<Scalar, Options...>>,
                           public Parameters<
                                 List<Options...>,
                                 OptionalValue<int, Length, Eigen::Dynamic>,
                                 OptionalValue<int, Stages, 1>,
-                                OptionalValue<int, Channels, 1>
+                                OptionalValue<int, Channels, 1>,
+                                OptionalValue<SummationMode, Summation, Resync>
                             >
     {
     public:
-        using State  = MAvgState <Scalar, MovingAverage::length, MovingAverage::channels, MovingAverage::stages>;
+        using State  = MAvgState <Scalar, MovingAverage::length, MovingAverage::channels, MovingAverage::stages,
+                                  MovingAverage::summation>;
         using Coeffs = MAvgCoeffs<Scalar, MovingAverage::length, MovingAverage::stages>;
 
         MovingAverage() {}
@@ -30,6 +35,60 @@ namespace disiple {
     };
 
 
+    /// Moving averages of several lengths of the same signal, sharing one
+    /// history buffer sized for the longest window. Output has the
+    /// averages of all lengths stacked: for C channels and K lengths it
+    /// is (K*C)-by-time, row k*C+c holding length k of channel c.
+    template <typename Scalar, typename... Options>
+    class MultiMovingAverage : public Parameters<
+                                    List<Options...>,
+                                    OptionalValue<int, Channels, 1>,
+                                    OptionalValue<SummationMode, Summation, Resync>
+                                >
+    {
+    public:
+        using State  = MultiMAvgState <Scalar, MultiMovingAverage::channels, MultiMovingAverage::summation>;
+        using Coeffs = MultiMAvgCoeffs<Scalar>;
+
+        MultiMovingAverage() {}
+        explicit MultiMovingAverage(std::vector<int> lengths) : coeffs_(std::move(lengths)) {}
+
+        int num_lengths() const { return coeffs_.num_lengths(); }
+
+        State&        state()        { return state_; }
+        const State&  state()  const { return state_; }
+        Coeffs&       coeffs()       { return coeffs_; }
+        const Coeffs& coeffs() const { return coeffs_; }
+
+        /// Initialize filter state to zero.
+        void initialize() { state_.initialize(); }
+
+        /// Apply filter to x and write result to y
+        /// @param x Input array, channels-by-time
+        /// @param y Output array, (lengths*channels)-by-time
+        template <typename X, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>& y)
+        {
+            if (y.rows() != num_lengths() * x.rows() || y.cols() != x.cols())
+                throw std::invalid_argument("Output must be (lengths*channels)-by-time");
+
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            for (Eigen::DenseIndex i=0; i<x.cols(); ++i)
+            {
+                auto yi = y.col(i);
+                state_.apply(coeffs_, x.col(i), yi);
+            }
+        }
+
+        template <typename X, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>&& y) { apply(x, y); }
+
+    private:
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+
     template <typename Scalar, typename... Options>
     class CumMovingAverage : public FilterBase<Scalar, CumMovingAverage<Scalar, Options...>>,
                              public Parameters<
@@ -50,4 +109,131 @@ namespace disiple {
         Coeffs coeffs_;
     };
 
+
+    /// Cumulative mean, variance, minimum and maximum of every channel.
+    /// The output is the mean of all samples so far. Partial results of
+    /// consecutive or unrelated blocks, e.g. processed on different
+    /// threads, can be combined with merge(). apply(x, dry_run) updates
+    /// the statistics with a whole block at once.
+    template <typename Scalar, typename... Options>
+    class CumStatistics : public FilterBase<Scalar, CumStatistics<Scalar, Options...>>,
+                          public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+        using Base = FilterBase<Scalar, CumStatistics<Scalar, Options...>>;
+        using Vec  = Eigen::Array<Scalar, CumStatistics::channels, 1>;
+
+    public:
+        using State  = CumStatsState<Scalar, CumStatistics::channels>;
+        using Coeffs = CumMAvgCoeffs<Scalar>;
+
+        CumStatistics() {}
+
+        using Base::apply;
+
+        /// Update the statistics with a block, channels-by-time, without output
+        template <typename X>
+        void apply(const Eigen::ArrayBase<X>& x, DryRun)
+        {
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            state_.apply_block(x);
+        }
+
+        /// Combine with the statistics of other data
+        void merge(const CumStatistics& other) { state_.merge(other.state_); }
+
+        long long   count()    const { return state_.num_; }
+        const Vec&  mean()     const { return state_.mean_; }
+        const Vec&  min()      const { return state_.min_; }
+        const Vec&  max()      const { return state_.max_; }
+
+        /// Population variance, sum of squared deviations over count
+        Vec variance() const { return state_.m2_ / Scalar(state_.num_); }
+
+    private:
+        friend Base;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+
+    /// Exponentially weighted moving average: a sample of age k has
+    /// weight alpha*(1-alpha)^k. O(1) memory per channel and no division.
+    /// apply(x, dry_run) updates the state with a whole block in closed
+    /// form, see mean() for the result.
+    template <typename Scalar, typename... Options>
+    class ExpMovingAverage : public FilterBase<Scalar, ExpMovingAverage<Scalar, Options...>>,
+                             public Parameters<
+                                    List<Options...>,
+                                    OptionalValue<int, Channels, 1>
+                                >
+    {
+        using Base = FilterBase<Scalar, ExpMovingAverage<Scalar, Options...>>;
+
+    public:
+        using State  = EMAState <Scalar, ExpMovingAverage::channels, false>;
+        using Coeffs = EMACoeffs<Scalar>;
+
+        ExpMovingAverage() {}
+        explicit ExpMovingAverage(double alpha) : coeffs_(alpha) {}
+
+        using Base::apply;
+
+        /// Update the state with a block, channels-by-time, without output
+        template <typename X>
+        void apply(const Eigen::ArrayBase<X>& x, DryRun)
+        {
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            state_.apply_block(coeffs_, x);
+        }
+
+        const Eigen::Array<Scalar, ExpMovingAverage::channels, 1>& mean() const { return state_.mean_; }
+
+    private:
+        friend Base;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+
+    /// Exponentially weighted moving variance, with the same weights as
+    /// ExpMovingAverage. The output is the variance, see mean() for the
+    /// weighted mean. apply(x, dry_run) updates a whole block in closed form.
+    template <typename Scalar, typename... Options>
+    class ExpMovingVariance : public FilterBase<Scalar, ExpMovingVariance<Scalar, Options...>>,
+                              public Parameters<
+                                    List<Options...>,
+                                    OptionalValue<int, Channels, 1>
+                                >
+    {
+        using Base = FilterBase<Scalar, ExpMovingVariance<Scalar, Options...>>;
+
+    public:
+        using State  = EMAState <Scalar, ExpMovingVariance::channels, true>;
+        using Coeffs = EMACoeffs<Scalar>;
+
+        ExpMovingVariance() {}
+        explicit ExpMovingVariance(double alpha) : coeffs_(alpha) {}
+
+        using Base::apply;
+
+        /// Update the state with a block, channels-by-time, without output
+        template <typename X>
+        void apply(const Eigen::ArrayBase<X>& x, DryRun)
+        {
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            state_.apply_block(coeffs_, x);
+        }
+
+        const Eigen::Array<Scalar, ExpMovingVariance::channels, 1>& mean()     const { return state_.mean_; }
+        const Eigen::Array<Scalar, ExpMovingVariance::channels, 1>& variance() const { return state_.var_; }
+
+    private:
+        friend Base;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
 }
@@ -9,20 +9,30 @@ namespace disiple {
 
     /// Polynomial FIR filter.
     /// A polynomial filter's weights are given by
-    ///     $$ w_t = \sum_i a_i t^j $$
+    ///     $$ w_t = \sum_i a_i t^i $$
     /// where the $a_i$ are rational functions of the window length T:
     ///     $$ a_i = \sum_j p_ij n^j / \sum_k q_ik n^k $$
-    /// with $t \in [1, T]$, $i \in [0, I)$, $j \in [0, J)$ and $k \in [0, K)$.
+    /// with $t \in [1, T]$, $i \in [0, I)$, $j \in [0, J)$ and $k \in [0, K)$,
+    /// and t = 1 for the newest sample. The filter is computed with I
+    /// cascaded running sums, whose weights are binomial coefficients in t;
+    /// the $a_i$ are rewritten in that basis, so that the weights above hold
+    /// for any I. Note: for I >= 3 the output differs from earlier versions,
+    /// which removed samples from the sums with weights n^i and drifted; for
+    /// I <= 2 both bases agree and the output is unchanged.
+    /// The Summation option chooses how the recursive sums are protected
+    /// against accumulating rounding errors, see MovingAverage.
     template <typename Scalar, int I, int J, int K, typename... Options>
     struct PolynomialFIR : public FilterBase<Scalar, PolynomialFIR<Scalar, I, J, K, Options...>>,
                            public Parameters<
                                 List<Options...>,
                                 OptionalValue<int, Length, Eigen::Dynamic>,
-                                OptionalValue<int, Channels, 1>
+                                OptionalValue<int, Channels, 1>,
+                                OptionalValue<SummationMode, Summation, Resync>
                             >
     {
     public:
-        using State  = PolyFIRState<Scalar, PolynomialFIR::length, PolynomialFIR::channels, I>;
+        using State  = PolyFIRState<Scalar, PolynomialFIR::length, PolynomialFIR::channels, I,
+                                     PolynomialFIR::summation>;
         using Coeffs = PolyFIRCoeffs<Scalar, PolynomialFIR::length, I, J, K>;
 
         PolynomialFIR() {}
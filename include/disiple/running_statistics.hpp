@@ -3,7 +3,8 @@
 #include <disiple/impl/filter_base.hpp>
 #include <disiple/impl/running_stats_impl.hpp>
 #include <disiple/named_params.hpp>
-#include <deque>
+#include <functional>
+#include <stdexcept>
 
 namespace disiple {
 
@@ -52,6 +53,58 @@ namespace disiple {
         Coeffs coeffs_;
     };
 
+    /// Position of the running minimum: the output is the lag of the
+    /// minimum within the last len samples, 0 meaning the newest sample.
+    /// value() and index() give the minimum itself and its absolute sample
+    /// index, counted from the last initialize().
+    template <typename Scalar, typename... Options>
+    class RunningArgMin : public FilterBase<Scalar, RunningArgMin<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningArgMinMaxState<Scalar, RunningArgMin::channels, std::less>;
+        using Coeffs = RunningMinMaxCoeffs<Scalar>;
+
+        explicit RunningArgMin(int len) : coeffs_(len) {}
+
+        Scalar    value(int channel) const { return state_.queue_.front(channel); }
+        long long index(int channel) const { return state_.queue_.front_index(channel); }
+
+    private:
+        friend FilterBase<Scalar, RunningArgMin<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Position of the running maximum: the output is the lag of the
+    /// maximum within the last len samples, 0 meaning the newest sample.
+    /// value() and index() give the maximum itself and its absolute sample
+    /// index, counted from the last initialize().
+    template <typename Scalar, typename... Options>
+    class RunningArgMax : public FilterBase<Scalar, RunningArgMax<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningArgMinMaxState<Scalar, RunningArgMax::channels, std::greater>;
+        using Coeffs = RunningMinMaxCoeffs<Scalar>;
+
+        explicit RunningArgMax(int len) : coeffs_(len) {}
+
+        Scalar    value(int channel) const { return state_.queue_.front(channel); }
+        long long index(int channel) const { return state_.queue_.front_index(channel); }
+
+    private:
+        friend FilterBase<Scalar, RunningArgMax<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
     template <typename Scalar, typename... Options>
     class RunningRange : public FilterBase<Scalar, RunningRange<Scalar, Options...>>,
                          public Parameters<
@@ -72,4 +125,222 @@ namespace disiple {
         Coeffs coeffs_;
     };
 
+
+    /// Running quantile of the last len samples of every channel, linearly
+    /// interpolated between order statistics. Costs O(log len) per sample.
+    template <typename Scalar, typename... Options>
+    class RunningQuantile : public FilterBase<Scalar, RunningQuantile<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningQuantileState<Scalar, RunningQuantile::channels>;
+        using Coeffs = RunningQuantileCoeffs<Scalar>;
+
+        /// @param q Quantile in [0, 1], e.g. 0.9 for the 90th percentile
+        RunningQuantile(int len, double q) : coeffs_(len, q) {}
+
+    private:
+        friend FilterBase<Scalar, RunningQuantile<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Running median, e.g. to remove impulse noise
+    template <typename Scalar, typename... Options>
+    class RunningMedian : public FilterBase<Scalar, RunningMedian<Scalar, Options...>>,
+                          public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningQuantileState<Scalar, RunningMedian::channels>;
+        using Coeffs = RunningQuantileCoeffs<Scalar>;
+
+        explicit RunningMedian(int len) : coeffs_(len, 0.5) {}
+
+    private:
+        friend FilterBase<Scalar, RunningMedian<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Population variance of the last Length samples of every channel,
+    /// kept by a numerically stable sliding update over one shared history
+    template <typename Scalar, typename... Options>
+    class RunningVariance : public FilterBase<Scalar, RunningVariance<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Length, Eigen::Dynamic>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningMomentState<Scalar, RunningVariance::length, RunningVariance::channels,
+                                          RunningMoment::Variance>;
+        using Coeffs = RunningMomentCoeffs<Scalar, RunningVariance::length>;
+
+        RunningVariance() {}
+        explicit RunningVariance(int length) : coeffs_(length) {}
+
+    private:
+        friend FilterBase<Scalar, RunningVariance<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Standard deviation of the last Length samples, see RunningVariance
+    template <typename Scalar, typename... Options>
+    class RunningStd : public FilterBase<Scalar, RunningStd<Scalar, Options...>>,
+                       public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Length, Eigen::Dynamic>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningMomentState<Scalar, RunningStd::length, RunningStd::channels,
+                                          RunningMoment::Std>;
+        using Coeffs = RunningMomentCoeffs<Scalar, RunningStd::length>;
+
+        RunningStd() {}
+        explicit RunningStd(int length) : coeffs_(length) {}
+
+    private:
+        friend FilterBase<Scalar, RunningStd<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Standard score of each sample with respect to the last Length
+    /// samples including itself, (x - mean) / std; 0 where the window is
+    /// constant up to the rounding of its mean
+    template <typename Scalar, typename... Options>
+    class RunningZScore : public FilterBase<Scalar, RunningZScore<Scalar, Options...>>,
+                          public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Length, Eigen::Dynamic>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = RunningMomentState<Scalar, RunningZScore::length, RunningZScore::channels,
+                                          RunningMoment::ZScore>;
+        using Coeffs = RunningMomentCoeffs<Scalar, RunningZScore::length>;
+
+        RunningZScore() {}
+        explicit RunningZScore(int length) : coeffs_(length) {}
+
+    private:
+        friend FilterBase<Scalar, RunningZScore<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Histogram of every channel over all samples so far, with fixed
+    /// bins, for approximate quantiles of long recordings in bounded
+    /// memory. Histograms of different blocks or threads with the same
+    /// bins can be merged.
+    template <typename Scalar, typename... Options>
+    class Histogram : public Parameters<
+                            List<Options...>,
+                            OptionalValue<int, Channels, 1>
+                        >
+    {
+    public:
+        using State  = HistogramState<Scalar, Histogram::channels>;
+        using Coeffs = HistogramCoeffs;
+        using Vec    = Eigen::Array<double, Histogram::channels, 1>;
+
+        /// @param bins Number of bins of equal width covering [lower, upper)
+        Histogram(double lower, double upper, int bins) : coeffs_(lower, upper, bins) {}
+
+        void initialize() { state_.initialize(); }
+
+        /// Add samples
+        /// @param x Input array, channels-by-time
+        template <typename X>
+        void apply(const Eigen::ArrayBase<X>& x)
+        {
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            state_.apply(coeffs_, x);
+        }
+
+        /// Add the samples of another histogram with the same bins
+        void merge(const Histogram& other)
+        {
+            if (!(coeffs_ == other.coeffs_))
+                throw std::invalid_argument("Histogram: cannot merge histograms with different bins");
+            if (other.state_.counts_.size() == 0)
+                return;
+            if (state_.counts_.size() == 0)
+                state_.setup(coeffs_, static_cast<int>(other.state_.counts_.cols()));
+            else if (state_.counts_.cols() != other.state_.counts_.cols())
+                throw std::invalid_argument("Histogram: cannot merge histograms of different channel counts");
+            state_.merge(other.state_);
+        }
+
+        /// Approximate quantile q in [0, 1] of every channel, NaN without samples
+        Vec quantile(double q) const
+        {
+            Vec r(state_.num_.size());
+            for (int c = 0; c < r.size(); ++c)
+                r[c] = state_.quantile(coeffs_, c, q);
+            return r;
+        }
+
+        /// Counts, (bins+2)-by-channels: row 0 counts the samples below
+        /// lower, row bins+1 those at or above upper
+        const typename State::Counts& counts() const { return state_.counts_; }
+
+        const Eigen::Array<long long, Histogram::channels, 1>& count() const { return state_.num_; }
+        const Vec& min() const { return state_.min_; }
+        const Vec& max() const { return state_.max_; }
+
+        const Coeffs& coeffs() const { return coeffs_; }
+
+    private:
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Running minimum of a whole block at once, by the van Herk/Gil-Werman
+    /// algorithm: the same result as a freshly initialized RunningMin, but
+    /// branch-free and vectorized across channels, which pays off for
+    /// offline data. y may be x itself.
+    /// @param x   Input array, channels-by-time
+    /// @param len Window length
+    /// @param y   Output array, channels-by-time
+    template <typename X, typename Y>
+    void running_min(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>& y)
+    {
+        internal::block_min_max<true, false>(x, len, y);
+    }
+
+    template <typename X, typename Y>
+    void running_min(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>&& y) { running_min(x, len, y); }
+
+    /// Running maximum of a whole block at once, see running_min()
+    template <typename X, typename Y>
+    void running_max(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>& y)
+    {
+        internal::block_min_max<false, true>(x, len, y);
+    }
+
+    template <typename X, typename Y>
+    void running_max(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>&& y) { running_max(x, len, y); }
+
+    /// Running range of a whole block at once, see running_min()
+    template <typename X, typename Y>
+    void running_range(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>& y)
+    {
+        internal::block_min_max<true, true>(x, len, y);
+    }
+
+    template <typename X, typename Y>
+    void running_range(const Eigen::ArrayBase<X>& x, int len, Eigen::ArrayBase<Y>&& y) { running_range(x, len, y); }
+
 }
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <disiple/impl/filter_base.hpp>
+#include <disiple/impl/sdft_impl.hpp>
+#include <disiple/named_params.hpp>
+
+namespace disiple {
+
+    /// Sliding DFT over the last N samples at a few chosen frequencies
+    /// (normalized to Nyquist), with O(K) work per sample for K frequencies,
+    /// e.g. to track mains interference and its harmonics. The output has
+    /// the amplitudes of all frequencies stacked: for C channels and K
+    /// frequencies it is (K*C)-by-time, row k*C+c holding frequency k of
+    /// channel c. Amplitudes are updated every hop samples and held in
+    /// between. A damping r < 1 tapers the window exponentially, which
+    /// keeps rounding errors from accumulating over very long runs.
+    /// As the output has more rows than the input, this is not a
+    /// FilterBase: like MultiMovingAverage, it has no in-place or scalar
+    /// apply.
+    template <typename Scalar, typename... Options>
+    class SlidingDFT : public Parameters<
+                            List<Options...>,
+                            OptionalValue<int, Length, Eigen::Dynamic>,
+                            OptionalValue<int, Channels, 1>
+                        >
+    {
+    public:
+        using State  = SlidingDFTState <Scalar, SlidingDFT::length, SlidingDFT::channels>;
+        using Coeffs = SlidingDFTCoeffs<Scalar, SlidingDFT::length>;
+
+        SlidingDFT() {}
+        SlidingDFT(int N, const std::vector<double>& freqs, int hop = 1, double r = 1.0)
+        : coeffs_(N, freqs, hop, r) {}
+
+        int length()   const { return coeffs_.length(); }
+        int num_bins() const { return coeffs_.num_bins(); }
+
+        State&        state()        { return state_; }
+        const State&  state()  const { return state_; }
+        Coeffs&       coeffs()       { return coeffs_; }
+        const Coeffs& coeffs() const { return coeffs_; }
+
+        /// Amplitudes at the tracked frequencies, channels-by-bins
+        const Eigen::Array<Scalar, SlidingDFT::channels, Eigen::Dynamic>&
+        amplitudes() const { return state_.amp_; }
+
+        /// Initialize filter state to zero.
+        void initialize() { state_.initialize(); }
+
+        /// Initialize filter state to a constant (steady state) value.
+        template <typename X>
+        void initialize(const Eigen::ArrayBase<X>& x_ss)
+        {
+            state_.setup(coeffs_, static_cast<int>(x_ss.rows()));
+            state_.initialize(coeffs_, x_ss);
+        }
+
+        /// Apply filter to x and write result to y
+        /// @param x Input array, channels-by-time
+        /// @param y Output array, (bins*channels)-by-time
+        template <typename X, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>& y)
+        {
+            if (y.rows() != num_bins() * x.rows() || y.cols() != x.cols())
+                throw std::invalid_argument("Output must be (bins*channels)-by-time");
+
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            for (Eigen::DenseIndex i=0; i<x.cols(); ++i)
+            {
+                auto yi = y.col(i);
+                state_.apply(coeffs_, x.col(i), yi);
+            }
+        }
+
+        template <typename X, typename Y>
+        void apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>&& y) { apply(x, y); }
+
+        /// Update the sliding dft without computing amplitudes
+        /// @param x Input array, channels-by-time
+        template <typename X>
+        void apply(const Eigen::ArrayBase<X>& x, DryRun)
+        {
+            state_.setup(coeffs_, static_cast<int>(x.rows()));
+            for (Eigen::DenseIndex i=0; i<x.cols(); ++i)
+                state_.apply(coeffs_, x.col(i), dry_run);
+        }
+
+    private:
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <disiple/impl/constexpr_math.hpp>
+#include <stdexcept>
+
+namespace disiple {
+
+    //
+    // Compile-time design of fixed-order filters. The result is a literal
+    // type holding the second order sections, so that a filter such as
+    //
+    //     constexpr auto lp = butterworth_lowpass<float, 4>(.1);
+    //     IIR<float, Stages<2>> f(lp);
+    //
+    // is set up without any runtime design work.
+    //
+
+    template <typename Scalar, int Stages>
+    struct StaticIIRDesign
+    {
+        static_assert(Stages > 0, "A static design needs at least one stage");
+
+        // Same layout as SecondOrderSections::coeffs(i): b1 b2 m1 m2
+        Scalar coeffs[Stages][4];
+        Scalar scaling;
+
+        constexpr int num_stages() const { return Stages; }
+    };
+
+    namespace internal {
+
+        template <typename Scalar>
+        constexpr void biquad_from_pz_pair(Scalar (&c)[4],
+                                           cx::complex pole1, cx::complex zero1,
+                                           cx::complex pole2, cx::complex zero2)
+        {
+            if (zero1.imag() != 0) { // zero2 == conj(zero1)
+                c[0] = -Scalar(2 * zero1.real());
+                c[1] =  Scalar(cx::norm(zero1));
+            } else {                 // zero2.imag() == 0
+                c[0] = -Scalar(zero1.real() + zero2.real());
+                c[1] =  Scalar(zero1.real() * zero2.real());
+            }
+
+            if (pole1.imag() != 0) { // pole2 == conj(pole1)
+                c[2] =  Scalar(2 * pole1.real());
+                c[3] = -Scalar(cx::norm(pole1));
+            } else {                 // pole2.imag() == 0
+                c[2] =  Scalar(pole1.real() + pole2.real());
+                c[3] = -Scalar(pole1.real() * pole2.real());
+            }
+        }
+
+        // Butterworth prototype, transformed with the bilinear lowpass
+        // (sign = 1) or highpass (sign = -1) transform with warping f.
+        template <typename Scalar, int NumPoles>
+        constexpr StaticIIRDesign<Scalar, (NumPoles+1)/2>
+        static_butterworth(double f, double sign)
+        {
+            StaticIIRDesign<Scalar, (NumPoles+1)/2> d{};
+
+            const double n2 = 2 * NumPoles;
+            const int pairs = NumPoles / 2;
+
+            // analog zeros lie at infinity, they map to z = -sign
+            const cx::complex zero(-sign);
+
+            // the gain is normalized at z = sign, i.e. at DC or Nyquist
+            const double z1 = sign;
+            double gain = 1;
+
+            for (int i = 0; i < pairs; ++i)
+            {
+                const double theta = pi_half + (2 * i + 1) * pi/n2;
+                const cx::complex c = f * cx::complex(cx::cos(theta), cx::sin(theta));
+                const cx::complex pole = sign * (1. + c) / (1. - c);
+
+                biquad_from_pz_pair(d.coeffs[i], pole, zero, cx::conj(pole), zero);
+            }
+
+            if (NumPoles & 1)
+            {
+                const double c = -f;
+                const cx::complex pole(sign * (1. + c) / (1. - c));
+
+                biquad_from_pz_pair(d.coeffs[pairs], pole, zero, cx::complex(0), cx::complex(0));
+            }
+
+            for (int i = 0; i < (NumPoles+1)/2; ++i)
+            {
+                const double b1 = d.coeffs[i][0], b2 = d.coeffs[i][1];
+                const double m1 = d.coeffs[i][2], m2 = d.coeffs[i][3];
+                gain *= (1. + b1 * z1 + b2) / (1. - m1 * z1 - m2);
+            }
+
+            d.scaling = Scalar(1. / cx::abs(gain));
+            return d;
+        }
+
+    }
+
+    /// Butterworth lowpass of order NumPoles with normalized cutoff in [0,1],
+    /// designed at compile time.
+    template <typename Scalar, int NumPoles>
+    constexpr StaticIIRDesign<Scalar, (NumPoles+1)/2> butterworth_lowpass(double cutoff)
+    {
+        static_assert(NumPoles > 0, "Number of poles must be positive");
+        if (cutoff<0.0 || cutoff>1.0)
+            throw std::invalid_argument("Cutoff frequency must be in [0,1]");
+        return internal::static_butterworth<Scalar, NumPoles>(cx::tan(pi_half * cutoff), 1.);
+    }
+
+    /// Butterworth highpass of order NumPoles with normalized cutoff in [0,1],
+    /// designed at compile time.
+    template <typename Scalar, int NumPoles>
+    constexpr StaticIIRDesign<Scalar, (NumPoles+1)/2> butterworth_highpass(double cutoff)
+    {
+        static_assert(NumPoles > 0, "Number of poles must be positive");
+        if (cutoff<0.0 || cutoff>1.0)
+            throw std::invalid_argument("Cutoff frequency must be in [0,1]");
+        return internal::static_butterworth<Scalar, NumPoles>(1. / cx::tan(pi_half * cutoff), -1.);
+    }
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <disiple/fft.hpp>
+#include <disiple/filter_design.hpp>
+#include <Eigen/Core>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+namespace disiple {
+
+    /// Streaming short-time Fourier transform of multichannel data.
+    /// Input is fed in blocks of arbitrary size, channels-by-time. Every
+    /// hop samples (once the first length samples have arrived) the last
+    /// length samples are windowed and transformed, giving a frame of
+    /// half spectra, channels-by-(length/2+1). Frames are computed into
+    /// internal buffers, so no memory is allocated after the first block.
+    class STFT
+    {
+    public:
+        /// @param window Analysis window, e.g. hann(n/2, n-1-n/2); its
+        ///               size is the frame length
+        /// @param hop    Number of samples between consecutive frames
+        STFT(const FIRWindow& window, int hop, FFTBackend backend = FFTBackend::Default);
+
+        int length()   const { return static_cast<int>(fft_.length()); }
+        int hop()      const { return hop_; }
+        int num_bins() const { return length()/2 + 1; }
+
+        /// The window, in time order (oldest sample first)
+        const Eigen::ArrayXf& window() const { return window_; }
+
+        /// Discard all buffered input
+        void initialize();
+
+        /// Number of frames that n more input samples will complete
+        int frames_ready(int n) const { return n < countdown_ ? 0 : 1 + (n - countdown_) / hop_; }
+
+        /// Feed input and call f(frame) for each completed frame, where
+        /// frame is a const Eigen::ArrayXXcf&, channels-by-num_bins
+        /// @param x Input array, channels-by-time
+        /// @return  Number of frames
+        template <typename X, typename F, typename = std::enable_if_t<
+                      !std::is_base_of<Eigen::EigenBase<std::decay_t<F>>, std::decay_t<F>>::value>>
+        int apply(const Eigen::ArrayBase<X>& x, F&& f);
+
+        /// Feed input and write the completed frames into y
+        /// @param x Input array, channels-by-time
+        /// @param y Output, channels-by-(num_bins*frames): frame k is
+        ///          y.middleCols(k*num_bins, num_bins). Must be large
+        ///          enough for frames_ready(x.cols()) frames.
+        /// @return  Number of frames
+        template <typename X, typename Y>
+        int apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>& y);
+
+        template <typename X, typename Y>
+        int apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>&& y) { return apply(x, y); }
+
+    private:
+        void setup(int nchans);
+        void transform_frame();
+
+        FFT             fft_;
+        Eigen::ArrayXf  window_;
+        int             hop_;
+
+        Eigen::ArrayXXf  buf_;     // ring buffer, channels-by-length
+        Eigen::ArrayXXf  frame_;   // windowed frame in time order
+        Eigen::ArrayXXcf spec_;    // spectrum of the last frame
+        int pos_;                  // next write position in buf_
+        int countdown_;            // samples until the next frame
+    };
+
+
+    template <typename X, typename F, typename>
+    int STFT::apply(const Eigen::ArrayBase<X>& x, F&& f)
+    {
+        setup(static_cast<int>(x.rows()));
+
+        const int len = length();
+        int frames = 0;
+
+        for (Eigen::DenseIndex i = 0; i < x.cols(); )
+        {
+            // copy as many samples as possible in one go
+            const int n = std::min({ countdown_, len - pos_, static_cast<int>(x.cols() - i) });
+            buf_.middleCols(pos_, n) = x.middleCols(i, n).template cast<float>();
+            i += n;
+            pos_ = (pos_ + n) % len;
+
+            if ((countdown_ -= n) == 0)
+            {
+                transform_frame();
+                f(static_cast<const Eigen::ArrayXXcf&>(spec_));
+                countdown_ = hop_;
+                ++frames;
+            }
+        }
+
+        return frames;
+    }
+
+    template <typename X, typename Y>
+    int STFT::apply(const Eigen::ArrayBase<X>& x, Eigen::ArrayBase<Y>& y)
+    {
+        // a change of channel count resets the buffer and hence frames_ready()
+        setup(static_cast<int>(x.rows()));
+
+        const int nbins = num_bins();
+        if (y.rows() != x.rows() || y.cols() < frames_ready(static_cast<int>(x.cols())) * nbins)
+            throw std::invalid_argument("stft: output too small");
+
+        Eigen::DenseIndex col = 0;
+        return apply(x, [&](const Eigen::ArrayXXcf& frame) {
+            y.middleCols(col, nbins) = frame;
+            col += nbins;
+        });
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <disiple/impl/timed_stats_impl.hpp>
+#include <disiple/named_params.hpp>
+#include <functional>
+
+namespace disiple {
+
+    /// Running statistics of irregularly sampled streams: the window holds
+    /// the samples taken within the last horizon (in the unit of the
+    /// timestamps) instead of a fixed number of samples. Every column of
+    /// the input comes with a timestamp, e.g.
+    ///
+    ///     TimedRunningMax<float, Channels<3>> f(2.0);  // last 2 s
+    ///     f.apply(x, t, y);
+    ///
+    /// The buffers grow to the largest number of samples a window held,
+    /// then nothing is allocated anymore.
+
+    /// Minimum over a time horizon
+    template <typename Scalar, typename... Options>
+    class TimedRunningMin : public TimedFilterBase<Scalar, TimedRunningMin<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = TimedMinMaxState<Scalar, TimedRunningMin::channels, std::less>;
+        using Coeffs = TimedWindowCoeffs;
+
+        explicit TimedRunningMin(double horizon) : coeffs_(horizon) {}
+
+    private:
+        friend TimedFilterBase<Scalar, TimedRunningMin<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Maximum over a time horizon
+    template <typename Scalar, typename... Options>
+    class TimedRunningMax : public TimedFilterBase<Scalar, TimedRunningMax<Scalar, Options...>>,
+                            public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = TimedMinMaxState<Scalar, TimedRunningMax::channels, std::greater>;
+        using Coeffs = TimedWindowCoeffs;
+
+        explicit TimedRunningMax(double horizon) : coeffs_(horizon) {}
+
+    private:
+        friend TimedFilterBase<Scalar, TimedRunningMax<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+    /// Mean of the samples within a time horizon, each weighted equally
+    template <typename Scalar, typename... Options>
+    class TimedRunningMean : public TimedFilterBase<Scalar, TimedRunningMean<Scalar, Options...>>,
+                             public Parameters<
+                                List<Options...>,
+                                OptionalValue<int, Channels, 1>
+                            >
+    {
+    public:
+        using State  = TimedMeanState<Scalar, TimedRunningMean::channels>;
+        using Coeffs = TimedWindowCoeffs;
+
+        explicit TimedRunningMean(double horizon) : coeffs_(horizon) {}
+
+    private:
+        friend TimedFilterBase<Scalar, TimedRunningMean<Scalar, Options...>>;
+        State  state_;
+        Coeffs coeffs_;
+    };
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <disiple/stft.hpp>
+#include <Eigen/Core>
+
+namespace disiple {
+
+    enum class WelchAveraging
+    {
+        Running,    ///< Mean of all segments so far
+        Exponential ///< Exponentially weighted mean, new segments get weight max(alpha, 1/segments)
+    };
+
+    /// Welch estimate of power spectral densities, updated incrementally:
+    /// each new segment (see STFT) is folded into the average in O(1),
+    /// the history is never revisited. Optionally, the cross spectral
+    /// densities of all pairs of channels are estimated as well.
+    /// Densities are one-sided and refer to a sampling rate of 1, divide
+    /// them by the sampling rate to get units^2/Hz.
+    class Welch
+    {
+    public:
+        /// @param window        Analysis window, its size is the segment length
+        /// @param hop           Number of samples between consecutive segments
+        /// @param averaging     How segments are averaged
+        /// @param alpha         Weight of a new segment for exponential averaging
+        /// @param cross_spectra Whether to estimate cross spectral densities
+        Welch(const FIRWindow& window, int hop,
+              WelchAveraging averaging = WelchAveraging::Running, double alpha = 0.1,
+              bool cross_spectra = false, FFTBackend backend = FFTBackend::Default);
+
+        int num_bins()     const { return stft_.num_bins(); }
+        int num_chans()    const { return static_cast<int>(psd_.rows()); }
+        int num_segments() const { return nseg_; }
+
+        /// Discard all segments and buffered input
+        void initialize();
+
+        /// Feed input
+        /// @param x Input array, channels-by-time
+        /// @return  Number of new segments
+        template <typename X>
+        int apply(const Eigen::ArrayBase<X>& x)
+        {
+            return stft_.apply(x, [this](const Eigen::ArrayXXcf& spec) { add_segment(spec); });
+        }
+
+        /// Power spectral densities, channels-by-num_bins
+        const Eigen::ArrayXXf& psd() const { return psd_; }
+
+        /// Cross spectral density of channels i and j, conj(X_i) X_j
+        /// @throws std::runtime_error if cross spectra are not estimated
+        Eigen::ArrayXcf csd(int i, int j) const;
+
+        /// Magnitude squared coherence of channels i and j
+        /// @throws std::runtime_error if cross spectra are not estimated
+        Eigen::ArrayXf coherence(int i, int j) const;
+
+    private:
+        void add_segment(const Eigen::ArrayXXcf& spec);
+        int pair_index(int i, int j) const { return i * num_chans() - i * (i - 1) / 2 + (j - i); }
+
+        STFT            stft_;
+        WelchAveraging  averaging_;
+        double          alpha_;
+        bool            cross_;
+        Eigen::ArrayXf  scale_;   // one-sided density scaling per bin
+
+        Eigen::ArrayXXf  psd_;    // channels-by-bins
+        Eigen::ArrayXXcf csd_;    // upper triangle pairs (i <= j)-by-bins
+        int nseg_;
+    };
+
+}
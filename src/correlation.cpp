@@ -0,0 +1,146 @@
+#include <disiple/correlation.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace disiple {
+
+    using namespace Eigen;
+
+    void internal::correlate(const Ref<const ArrayXXf>& x,
+                             const std::vector<ChannelPair>& pairs, int max_lag,
+                             CorrelationScaling scaling, CorrelationBuffers& buf,
+                             Ref<ArrayXXf> r)
+    {
+        const Index nchans = x.rows(), n = x.cols();
+
+        if (max_lag < 0 || max_lag >= n)
+            throw std::invalid_argument("correlation: max_lag must be in [0, length)");
+        if (r.rows() != Index(pairs.size()) || r.cols() != 2*max_lag+1)
+            throw std::invalid_argument("correlation: unexpected output size");
+        for (const ChannelPair& p : pairs)
+            if (p.first < 0 || p.second < 0 || p.first >= nchans || p.second >= nchans)
+                throw std::invalid_argument("correlation: channel out of range");
+
+        // zero padding to n+max_lag avoids circular wrap-around up to max_lag
+        const size_t nfft = fft_fast_length(size_t(n + max_lag));
+        const FFT& fft = FFTRegistry::local().plan(nfft);
+
+        buf.padded.resize(nchans, nfft);
+        buf.padded.leftCols(n) = x;
+        buf.padded.rightCols(nfft - n).setZero();
+        buf.spectra.resize(nchans, nfft/2+1);
+        buf.product.resize(nfft/2+1);
+        buf.result.resize(nfft);
+
+        // every channel is transformed once, however many pairs it is in
+        fft.batch(buf.padded, buf.spectra);
+
+        if (scaling == CorrelationScaling::Coefficient)
+        {
+            buf.energy.resize(nchans);
+            for (Index c = 0; c < nchans; ++c)
+                buf.energy[c] = float(x.row(c).cast<double>().square().sum());
+        }
+
+        for (size_t p = 0; p < pairs.size(); ++p)
+        {
+            const int i = pairs[p].first, j = pairs[p].second;
+            buf.product = buf.spectra.row(i).transpose() * buf.spectra.row(j).transpose().conjugate();
+            fft.inverse(buf.product, buf.result);
+
+            // lags 0..max_lag come first, negative lags wrap around to the end
+            auto rp = r.row(p);
+            rp.tail(max_lag+1) = buf.result.head(max_lag+1).transpose();
+            rp.head(max_lag)   = buf.result.tail(max_lag).transpose();
+
+            if (scaling == CorrelationScaling::Coefficient)
+            {
+                const float norm = std::sqrt(buf.energy[i] * buf.energy[j]);
+                rp *= norm > 0 ? 1.0f / norm : 0.0f;
+            }
+        }
+
+        if (scaling == CorrelationScaling::Biased)
+            r /= float(n);
+        else if (scaling == CorrelationScaling::Unbiased)
+            for (int k = 0; k <= 2*max_lag; ++k)
+                r.col(k) /= float(n - std::abs(k - max_lag));
+    }
+
+    ArrayXf xcorr(const Ref<const ArrayXf>& x, const Ref<const ArrayXf>& y, int max_lag,
+                  CorrelationScaling scaling)
+    {
+        if (x.size() != y.size())
+            throw std::invalid_argument("xcorr: signals must have the same length");
+
+        ArrayXXf xy(2, x.size());
+        xy.row(0) = x.transpose();
+        xy.row(1) = y.transpose();
+
+        internal::CorrelationBuffers buf;
+        ArrayXXf r(1, 2*max_lag+1);
+        internal::correlate(xy, { ChannelPair(0, 1) }, max_lag, scaling, buf, r);
+        return r.row(0).transpose();
+    }
+
+    ArrayXXf xcorr(const Ref<const ArrayXXf>& x, const std::vector<ChannelPair>& pairs,
+                   int max_lag, CorrelationScaling scaling)
+    {
+        internal::CorrelationBuffers buf;
+        ArrayXXf r(pairs.size(), 2*max_lag+1);
+        internal::correlate(x, pairs, max_lag, scaling, buf, r);
+        return r;
+    }
+
+    ArrayXXf autocorr(const Ref<const ArrayXXf>& x, int max_lag, CorrelationScaling scaling)
+    {
+        std::vector<ChannelPair> pairs;
+        for (int c = 0; c < x.rows(); ++c)
+            pairs.emplace_back(c, c);
+
+        return xcorr(x, pairs, max_lag, scaling).rightCols(max_lag+1);
+    }
+
+    SlidingCorrelation::SlidingCorrelation(int window, int max_lag, int hop,
+                                           std::vector<ChannelPair> pairs,
+                                           CorrelationScaling scaling)
+    : window_(window), max_lag_(max_lag), hop_(hop)
+    , pairs_(std::move(pairs)), scaling_(scaling)
+    , pos_(0), countdown_(window)
+    {
+        if (window < 1 || hop < 1)
+            throw std::invalid_argument("correlation: window and hop must be positive");
+        if (max_lag < 0 || max_lag >= window)
+            throw std::invalid_argument("correlation: max_lag must be in [0, window)");
+
+        result_.resize(pairs_.size(), 2*max_lag_+1);
+    }
+
+    void SlidingCorrelation::initialize()
+    {
+        buf_.setZero();
+        pos_ = 0;
+        countdown_ = window_;
+    }
+
+    void SlidingCorrelation::setup(int nchans)
+    {
+        if (buf_.rows() != nchans)
+        {
+            buf_.resize(nchans, window_);
+            frame_.resize(nchans, window_);
+            initialize();
+        }
+    }
+
+    void SlidingCorrelation::correlate_window()
+    {
+        // unroll the ring buffer, the oldest sample is at pos_
+        frame_.leftCols(window_ - pos_) = buf_.rightCols(window_ - pos_);
+        frame_.rightCols(pos_)          = buf_.leftCols(pos_);
+
+        internal::correlate(frame_, pairs_, max_lag_, scaling_, work_, result_);
+    }
+
+}
@@ -1,91 +1,362 @@
 #include <disiple/fft.hpp>
+#include <disiple/impl/fft_backend.hpp>
+#include <disiple/impl/next_pow2.hpp>
+#include <disiple/impl/pole_zero_pair.hpp>
 
-// these typedefs must come before including Accelerate.h,
-// because Accelerate redefines std::complex
-using CF = std::complex<float>;
-using CD = std::complex<double>;
-
-#if USE_ACCELERATE
-#    include <Accelerate/Accelerate.h>
-#elif USE_PFFFT
-#    include <pffft/pffft.h>
-#else
-#    include <unsupported/Eigen/FFT>
-#endif
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 
 namespace disiple {
 
-    static unsigned int ilog2(size_t x) {
-        if (x == 0 || (x & (x - 1)))
-            throw std::runtime_error("Length must be a power of 2");
-        unsigned int y = 0;
-        while (x >>= 1) ++y;
-        return y;
+    using CF = std::complex<float>;
+
+    static bool is_pow2(size_t n) { return n && !(n & (n - 1)); }
+
+    static bool is_smooth(size_t n) {
+        if (n == 0)
+            return false;
+        for (size_t p : { 2, 3, 5 })
+            while (n % p == 0) n /= p;
+        return n == 1;
     }
 
-    FFT::FFT(size_t length)
-    : len_(length), loglen_(ilog2(length))
+    bool fft_backend_available(FFTBackend backend)
     {
+        switch (backend) {
+            case FFTBackend::Default:
+            case FFTBackend::Eigen:      return true;
+#if USE_PFFFT
+            case FFTBackend::PFFFT:      return true;
+#endif
 #if USE_ACCELERATE
-        impl_.reset(vDSP_create_fftsetup(loglen_, kFFTRadix2));
-        work_.resize(len_);
-#elif USE_PFFFT
-        impl_.reset(pffft_new_setup(boost::numeric_cast<int>(len_), PFFFT_REAL));
-        work_.resize(len_);
-#else
-        auto* p = new Eigen::FFT<float>;
-        p->SetFlag(Eigen::FFT<float>::HalfSpectrum);
-        impl_.reset(p);
+            case FFTBackend::Accelerate: return true;
 #endif
+            default:                     return false;
+        }
     }
 
-    void FFT::ImplDeleter::operator()(void* p) const
+    static FFTBackend resolve(FFTBackend backend)
     {
+        if (backend != FFTBackend::Default)
+            return backend;
 #if USE_ACCELERATE
-        vDSP_destroy_fftsetup(static_cast<FFTSetup>(p));
+        return FFTBackend::Accelerate;
 #elif USE_PFFFT
-        pffft_destroy_setup(static_cast<PFFFT_Setup*>(p));
+        return FFTBackend::PFFFT;
 #else
-        delete static_cast<Eigen::FFT<float>*>(p);
+        return FFTBackend::Eigen;
 #endif
     }
 
+    // lengths supported by the backend itself
+    static bool is_native(FFTBackend backend, size_t n) {
+        switch (resolve(backend)) {
+            case FFTBackend::Accelerate: return is_pow2(n);
+            case FFTBackend::PFFFT:      return is_smooth(n) && n % 32 == 0;
+            default:                     return is_smooth(n);
+        }
+    }
+
+    size_t fft_fast_length(size_t n, FFTBackend backend)
+    {
+        while (!is_native(backend, n)) ++n;
+        return n;
+    }
+
     using namespace Eigen;
 
+    namespace {
+
+        // thread-local scratch memory, so that FFT instances can be shared
+        struct Scratch
+        {
+            ArrayXf  work;   // used by the backends
+            ArrayXf  real;   // used by the batch transforms
+            ArrayXcf spec;
+            ArrayXcf chirp;  // used by Bluestein's algorithm
+            ArrayXcf conv_a, conv_b;
+        };
+
+        Scratch& scratch()
+        {
+            static thread_local Scratch s;
+            return s;
+        }
+
+        template <typename A>
+        typename A::Scalar* sized(A& a, size_t n)
+        {
+            if (static_cast<size_t>(a.size()) < n)
+                a.resize(n);
+            return a.data();
+        }
+
+        void check_size(const char* what, Index actual, size_t expected)
+        {
+            if (static_cast<size_t>(actual) != expected)
+                throw std::runtime_error(std::string("fft: unexpected ") + what + " size: " +
+                                         std::to_string(actual));
+        }
+
+        std::unique_ptr<internal::FFTBackendImpl> make_backend(FFTBackend backend, size_t n)
+        {
+            switch (backend) {
+#if USE_PFFFT
+                case FFTBackend::PFFFT:      return internal::make_pffft(n);
+#endif
+#if USE_ACCELERATE
+                case FFTBackend::Accelerate: return internal::make_accelerate_fft(n);
+#endif
+                default:                     return internal::make_eigen_fft(n);
+            }
+        }
+    }
+
+    float* internal::fft_work(size_t n)
+    {
+        return sized(scratch().work, n);
+    }
+
+    // Bluestein's algorithm: a dft of arbitrary length n, expressed as a
+    // convolution with a chirp, which is computed with ffts of a power of
+    // two length m >= 2n-1:
+    //     X[k] = w[k] * sum_t (x[t] w[t]) conj(w[k-t]),  w[k] = exp(-i pi k^2 / n)
+    struct FFT::Bluestein
+    {
+        Bluestein(size_t n, FFTBackend backend)
+        : inner(std::max<size_t>(next_pow2(2*n-1), 32), backend)
+        , chirp(n)
+        , filter(inner.length())
+        {
+            const size_t m = inner.length();
+            for (size_t k = 0; k < n; ++k) {
+                // k^2 mod 2n keeps the argument small and accurate
+                const double kk = double((k * k) % (2 * n));
+                chirp[k] = CF(std::polar(1.0, -pi * kk / double(n)));
+            }
+
+            ArrayXcf b = ArrayXcf::Zero(m);
+            b[0] = std::conj(chirp[0]);
+            for (size_t k = 1; k < n; ++k)
+                b[k] = b[m-k] = std::conj(chirp[k]);
+            inner.cfwd(b.data(), filter.data());
+        }
+
+        // forward complex dft, x and y may alias
+        void transform(const CF* x, CF* y) const
+        {
+            const Index n = chirp.size(), m = filter.size();
+            Scratch& s = scratch();
+            Map<ArrayXcf, Aligned> a(sized(s.conv_a, m), m), b(sized(s.conv_b, m), m);
+
+            a.head(n) = Map<const ArrayXcf>(x, n) * chirp;
+            a.tail(m - n).setZero();
+            inner.cfwd(a.data(), b.data());
+            b *= filter;
+            inner.cinv(b.data(), a.data());
+            Map<ArrayXcf>(y, n) = a.head(n) * chirp;
+        }
+
+        FFT      inner;
+        ArrayXcf chirp;
+        ArrayXcf filter;
+    };
+
+    FFT::FFT(size_t length, FFTBackend backend)
+    : len_(length), backend_(resolve(backend))
+    {
+        if (length == 0)
+            throw std::invalid_argument("fft: length must be positive");
+        if (!fft_backend_available(backend_))
+            throw std::invalid_argument("fft: backend not available in this build");
+
+        if (is_native(backend_, len_))
+            impl_ = make_backend(backend_, len_);
+        else
+            bluestein_ = std::make_shared<const Bluestein>(len_, backend_);
+    }
+
+    void FFT::fwd(const float* x, CF* y) const
+    {
+        if (bluestein_) {
+            Map<ArrayXcf, Aligned> c(sized(scratch().chirp, len_), len_);
+            c = Map<const ArrayXf>(x, len_).cast<CF>();
+            bluestein_->transform(c.data(), c.data());
+            Map<ArrayXcf>(y, len_/2+1) = c.head(len_/2+1);
+            return;
+        }
+
+        impl_->fwd(x, y);
+    }
+
+    void FFT::inv(const CF* y, float* x) const
+    {
+        if (bluestein_) {
+            // restore the full, hermitian spectrum and use
+            // ifft(y) = conj(fft(conj(y))) / n, with real output
+            Map<ArrayXcf, Aligned> c(sized(scratch().chirp, len_), len_);
+            c.head(len_/2+1) = Map<const ArrayXcf>(y, len_/2+1).conjugate();
+            for (size_t k = len_/2+1; k < len_; ++k)
+                c[k] = y[len_-k];
+            bluestein_->transform(c.data(), c.data());
+            Map<ArrayXf>(x, len_) = c.real() / float(len_);
+            return;
+        }
+
+        impl_->inv(y, x);
+    }
+
+    void FFT::cfwd(const CF* x, CF* y) const
+    {
+        if (bluestein_) {
+            bluestein_->transform(x, y);
+            return;
+        }
+
+        impl_->cfwd(x, y);
+    }
+
+    void FFT::cinv(const CF* y, CF* x) const
+    {
+        if (bluestein_) {
+            Map<ArrayXcf> out(x, len_);
+            out = Map<const ArrayXcf>(y, len_).conjugate();
+            bluestein_->transform(x, x);
+            out = out.conjugate() / float(len_);
+            return;
+        }
+
+        impl_->cinv(y, x);
+    }
+
     void FFT::operator()(Ref<const ArrayXf, Aligned> x,
                          Ref<ArrayXcf, Aligned> y) const
     {
-        if (static_cast<size_t>(x.size()) != len_)
-            throw std::runtime_error(std::string("fft: unexpected input size: ") +
-                                     std::to_string(x.size()));
-
-        if (static_cast<size_t>(y.size()) != len_/2+1)
-            throw std::runtime_error(std::string("fft: unexpected output size: ") +
-                                     std::to_string(y.size()));
+        check_size("input", x.size(), len_);
+        check_size("output", y.size(), len_/2+1);
 
         //perform fft
-#if USE_ACCELERATE
-        const size_t halflen = len_/2;
-        DSPSplitComplex y_spl = { (float*) y.data(), (float*) y.data() + halflen };
-        DSPSplitComplex w_spl = { work_.data(), work_.data() + halflen };
-
-        //copy x's contents to w in split complex format
-        vDSP_ctoz(reinterpret_cast<DSPComplex const*>(x.data()), 2, &w_spl, 1, halflen);
-        //in-place fft(w), use y as temporary working area
-        vDSP_fft_zript(static_cast<FFTSetup>(impl_.get()), &w_spl, 1, &y_spl, loglen_, FFT_FORWARD);
-        //un-scale spectrum, see vDSP reference
-        vDSP_ztoc(&w_spl, 1, reinterpret_cast<DSPComplex*>(y.data()), 2, halflen);
-        y *= 0.5f;
-        y[len_/2] = CF(y[0].imag(), 0); y[0] = CF(y[0].real(), 0); //unmix DC and Nyquist
-#elif USE_PFFFT
-        pffft_transform_ordered(static_cast<PFFFT_Setup*>(impl_.get()),
-                                x.data(), reinterpret_cast<float*>(y.data()),
-                                work_.data(), PFFFT_FORWARD);
-        y[len_/2] = CF(y[0].imag(), 0); y[0] = CF(y[0].real(), 0); //unmix DC and Nyquist
-#else
-        Eigen::FFT<float>* fft = static_cast<Eigen::FFT<float>*>(impl_.get());
-        fft->fwd(y.data(), x.data(), len_);
-#endif
+        fwd(x.data(), y.data());
+    }
+
+    void FFT::inverse(Ref<const ArrayXcf, Aligned> y,
+                      Ref<ArrayXf, Aligned> x) const
+    {
+        check_size("input", y.size(), len_/2+1);
+        check_size("output", x.size(), len_);
+
+        inv(y.data(), x.data());
+    }
+
+    void FFT::complex_forward(Ref<const ArrayXcf, Aligned> x,
+                              Ref<ArrayXcf, Aligned> y) const
+    {
+        check_size("input", x.size(), len_);
+        check_size("output", y.size(), len_);
+
+        cfwd(x.data(), y.data());
+    }
+
+    void FFT::complex_inverse(Ref<const ArrayXcf, Aligned> y,
+                              Ref<ArrayXcf, Aligned> x) const
+    {
+        check_size("input", y.size(), len_);
+        check_size("output", x.size(), len_);
+
+        cinv(y.data(), x.data());
+    }
+
+    void FFT::batch(const Ref<const ArrayXXf>& x, Ref<ArrayXXcf> y) const
+    {
+        check_size("input", x.cols(), len_);
+        check_size("output", y.cols(), len_/2+1);
+        check_size("output", y.rows(), x.rows());
+
+        // channels are rows, so they are strided: transform via
+        // contiguous thread-local buffers
+        Scratch& s = scratch();
+        Map<ArrayXf,  Aligned> xi(sized(s.real, len_), len_);
+        Map<ArrayXcf, Aligned> yi(sized(s.spec, len_/2+1), len_/2+1);
+
+        for (Index c = 0; c < x.rows(); ++c)
+        {
+            xi = x.row(c).transpose();
+            fwd(xi.data(), yi.data());
+            y.row(c) = yi.transpose();
+        }
+    }
+
+    void FFT::batch_inverse(const Ref<const ArrayXXcf>& y, Ref<ArrayXXf> x) const
+    {
+        check_size("input", y.cols(), len_/2+1);
+        check_size("output", x.cols(), len_);
+        check_size("output", x.rows(), y.rows());
+
+        Scratch& s = scratch();
+        Map<ArrayXcf, Aligned> yi(sized(s.spec, len_/2+1), len_/2+1);
+        Map<ArrayXf,  Aligned> xi(sized(s.real, len_), len_);
+
+        for (Index c = 0; c < y.rows(); ++c)
+        {
+            yi = y.row(c).transpose();
+            inv(yi.data(), xi.data());
+            x.row(c) = xi.transpose();
+        }
+    }
+
+    namespace {
+
+        // plans shared by all threads; never removed, so pointers stay valid
+        struct SharedPlans
+        {
+            std::mutex                                          mut;
+            std::unordered_map<size_t, std::unique_ptr<FFT>>    plans;
+        };
+
+        SharedPlans& shared_plans()
+        {
+            static SharedPlans p;
+            return p;
+        }
+    }
+
+    FFTRegistry& FFTRegistry::local()
+    {
+        static thread_local FFTRegistry registry;
+        return registry;
+    }
+
+    const FFT& FFTRegistry::plan(size_t length)
+    {
+        auto it = plans_.find(length);
+        if (it != plans_.end())
+            return *it->second;
+
+        SharedPlans& shared = shared_plans();
+        std::lock_guard<std::mutex> locker(shared.mut);
+
+        auto& p = shared.plans[length];
+        if (!p)
+            p.reset(new FFT(length));
+
+        plans_.emplace(length, p.get());
+        return *p;
+    }
+
+    ArrayXf& FFTRegistry::real_buffer(size_t size)
+    {
+        if (static_cast<size_t>(real_.size()) != size)
+            real_.resize(size);
+        return real_;
+    }
+
+    ArrayXcf& FFTRegistry::complex_buffer(size_t size)
+    {
+        if (static_cast<size_t>(complex_.size()) != size)
+            complex_.resize(size);
+        return complex_;
     }
 
 }
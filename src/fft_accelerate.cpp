@@ -0,0 +1,100 @@
+#include <disiple/impl/fft_backend.hpp>
+
+// these typedefs must come before including Accelerate.h,
+// because Accelerate redefines std::complex
+using CF = std::complex<float>;
+using CD = std::complex<double>;
+
+#include <Accelerate/Accelerate.h>
+
+#include <Eigen/Core>
+
+namespace disiple {
+namespace internal {
+
+    namespace {
+
+        unsigned int ilog2(size_t x) {
+            unsigned int y = 0;
+            while (x >>= 1) ++y;
+            return y;
+        }
+
+        class AccelerateFFT : public FFTBackendImpl
+        {
+        public:
+            explicit AccelerateFFT(size_t n)
+            : setup_(vDSP_create_fftsetup(ilog2(n), kFFTRadix2))
+            , len_(n), loglen_(ilog2(n))
+            {}
+
+            AccelerateFFT(const AccelerateFFT&) = delete;
+            ~AccelerateFFT() override { vDSP_destroy_fftsetup(setup_); }
+
+            void fwd(const float* x, CF* y) const override
+            {
+                const size_t halflen = len_/2;
+                float* work = fft_work(len_);
+                DSPSplitComplex y_spl = { (float*) y, (float*) y + halflen };
+                DSPSplitComplex w_spl = { work, work + halflen };
+
+                //copy x's contents to w in split complex format
+                vDSP_ctoz(reinterpret_cast<DSPComplex const*>(x), 2, &w_spl, 1, halflen);
+                //in-place fft(w), use y as temporary working area
+                vDSP_fft_zript(setup_, &w_spl, 1, &y_spl, loglen_, FFT_FORWARD);
+                //un-scale spectrum, see vDSP reference
+                vDSP_ztoc(&w_spl, 1, reinterpret_cast<DSPComplex*>(y), 2, halflen);
+                Eigen::Map<Eigen::ArrayXcf>(y, halflen+1) *= 0.5f;
+                y[halflen] = CF(y[0].imag(), 0); y[0] = CF(y[0].real(), 0); //unmix DC and Nyquist
+            }
+
+            void inv(const CF* y, float* x) const override
+            {
+                const size_t halflen = len_/2;
+                float* work = fft_work(2*len_);
+                DSPSplitComplex w_spl = { work, work + halflen };
+                DSPSplitComplex t_spl = { work + len_, work + len_ + halflen };
+
+                //mix DC and Nyquist, copy to w in split complex format
+                vDSP_ctoz(reinterpret_cast<DSPComplex const*>(y), 2, &w_spl, 1, halflen);
+                w_spl.imagp[0] = y[halflen].real();
+                vDSP_fft_zript(setup_, &w_spl, 1, &t_spl, loglen_, FFT_INVERSE);
+                vDSP_ztoc(&w_spl, 1, reinterpret_cast<DSPComplex*>(x), 2, halflen);
+                Eigen::Map<Eigen::ArrayXf>(x, len_) *= 1.0f / float(len_);
+            }
+
+            void cfwd(const CF* x, CF* y) const override
+            {
+                float* work = fft_work(2*len_);
+                DSPSplitComplex w_spl = { work, work + len_ };
+
+                vDSP_ctoz(reinterpret_cast<DSPComplex const*>(x), 2, &w_spl, 1, len_);
+                vDSP_fft_zip(setup_, &w_spl, 1, loglen_, FFT_FORWARD);
+                vDSP_ztoc(&w_spl, 1, reinterpret_cast<DSPComplex*>(y), 2, len_);
+            }
+
+            void cinv(const CF* y, CF* x) const override
+            {
+                float* work = fft_work(2*len_);
+                DSPSplitComplex w_spl = { work, work + len_ };
+
+                vDSP_ctoz(reinterpret_cast<DSPComplex const*>(y), 2, &w_spl, 1, len_);
+                vDSP_fft_zip(setup_, &w_spl, 1, loglen_, FFT_INVERSE);
+                vDSP_ztoc(&w_spl, 1, reinterpret_cast<DSPComplex*>(x), 2, len_);
+                Eigen::Map<Eigen::ArrayXcf>(x, len_) *= 1.0f / float(len_);
+            }
+
+        private:
+            FFTSetup     setup_;
+            size_t       len_;
+            unsigned int loglen_;
+        };
+    }
+
+    std::unique_ptr<FFTBackendImpl> make_accelerate_fft(size_t n)
+    {
+        return std::unique_ptr<FFTBackendImpl>(new AccelerateFFT(n));
+    }
+
+}
+}
@@ -0,0 +1,39 @@
+#include <disiple/impl/fft_backend.hpp>
+
+#include <unsupported/Eigen/FFT>
+
+namespace disiple {
+namespace internal {
+
+    namespace {
+
+        // Eigen::FFT keeps mutable plans and buffers, so use one per thread
+        Eigen::FFT<float>& eigen_fft()
+        {
+            static thread_local Eigen::FFT<float> fft;
+            fft.SetFlag(Eigen::FFT<float>::HalfSpectrum);
+            return fft;
+        }
+
+        class EigenFFT : public FFTBackendImpl
+        {
+        public:
+            explicit EigenFFT(size_t n) : len_(n) {}
+
+            void fwd (const float* x, CF* y) const override { eigen_fft().fwd(y, x, len_); }
+            void inv (const CF* y, float* x) const override { eigen_fft().inv(x, y, len_); }
+            void cfwd(const CF* x, CF* y) const override    { eigen_fft().fwd(y, x, len_); }
+            void cinv(const CF* y, CF* x) const override    { eigen_fft().inv(x, y, len_); }
+
+        private:
+            size_t len_;
+        };
+    }
+
+    std::unique_ptr<FFTBackendImpl> make_eigen_fft(size_t n)
+    {
+        return std::unique_ptr<FFTBackendImpl>(new EigenFFT(n));
+    }
+
+}
+}
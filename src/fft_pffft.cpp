@@ -0,0 +1,82 @@
+#include <disiple/impl/fft_backend.hpp>
+
+#include <pffft/pffft.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace disiple {
+namespace internal {
+
+    namespace {
+
+        struct SetupDeleter
+        {
+            void operator()(PFFFT_Setup* p) const { pffft_destroy_setup(p); }
+        };
+
+        using Setup = std::unique_ptr<PFFFT_Setup, SetupDeleter>;
+
+        class PFFFT : public FFTBackendImpl
+        {
+        public:
+            explicit PFFFT(size_t n)
+            : real_(pffft_new_setup(static_cast<int>(n), PFFFT_REAL))
+            , complex_(pffft_new_setup(static_cast<int>(n), PFFFT_COMPLEX))
+            , len_(n)
+            {
+                if (!real_ || !complex_)
+                    throw std::invalid_argument("fft: length not supported by pffft: " + std::to_string(n));
+            }
+
+            void fwd(const float* x, CF* y) const override
+            {
+                pffft_transform_ordered(real_.get(), x, reinterpret_cast<float*>(y),
+                                        fft_work(len_), PFFFT_FORWARD);
+                y[len_/2] = CF(y[0].imag(), 0); y[0] = CF(y[0].real(), 0); //unmix DC and Nyquist
+            }
+
+            void inv(const CF* y, float* x) const override
+            {
+                const size_t halflen = len_/2;
+                float* work = fft_work(2*len_);
+                float* packed = work + len_;
+
+                //mix DC and Nyquist
+                packed[0] = y[0].real(); packed[1] = y[halflen].real();
+                std::copy(reinterpret_cast<const float*>(y + 1),
+                          reinterpret_cast<const float*>(y + halflen), packed + 2);
+                pffft_transform_ordered(real_.get(), packed, x, work, PFFFT_BACKWARD);
+                Eigen::Map<Eigen::ArrayXf>(x, len_) *= 1.0f / float(len_);
+            }
+
+            void cfwd(const CF* x, CF* y) const override
+            {
+                pffft_transform_ordered(complex_.get(),
+                                        reinterpret_cast<const float*>(x), reinterpret_cast<float*>(y),
+                                        fft_work(2*len_), PFFFT_FORWARD);
+            }
+
+            void cinv(const CF* y, CF* x) const override
+            {
+                pffft_transform_ordered(complex_.get(),
+                                        reinterpret_cast<const float*>(y), reinterpret_cast<float*>(x),
+                                        fft_work(2*len_), PFFFT_BACKWARD);
+                Eigen::Map<Eigen::ArrayXcf>(x, len_) *= 1.0f / float(len_);
+            }
+
+        private:
+            Setup  real_, complex_;
+            size_t len_;
+        };
+    }
+
+    std::unique_ptr<FFTBackendImpl> make_pffft(size_t n)
+    {
+        return std::unique_ptr<FFTBackendImpl>(new PFFFT(n));
+    }
+
+}
+}
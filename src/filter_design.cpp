@@ -3,8 +3,6 @@
 #include <disiple/impl/next_pow2.hpp>
 
 #include <Eigen/Dense>
-#include <unordered_map>
-#include <mutex>
 
 namespace disiple {
 
@@ -69,25 +67,45 @@ namespace disiple {
 
         const double gain = 1.0/(1.0+tan(0.25*N*BW*pi));
 
-        Eigen::MatrixXd m(N, N);
-        m.fill(0);
-        m(0,N-1) = 2*gain-1;
-        m.block(1, 0, N-1, N-1).setIdentity();
-
-        Complex v= m.eigenvalues().coeff(N-1);
+        // the poles are the N-th roots of a = 2*gain-1, on a circle of
+        // radius |a|^(1/N): for a >= 0 at the angles of the zeros, 2 pi i/N,
+        // for a < 0 halfway between them, (2i+1) pi/N
+        const double a = 2*gain-1;
+        const double rho = std::pow(std::abs(a), 1.0/N);
 
         // find poles and zeros
-        const int pairs = N / 2;
+        const int pairs = (N - 1) / 2;
 
-        for(int i=1;i<=pairs;i++)
+        if (a >= 0 || (N & 1))
         {
-            const double W = i* 2*pi/N;
-            Complex zero = Complex(cos(W), sin(W));
-            result.add_conjugate_pair(v.real()*zero, zero);
+            // for odd N, the roots of a < 0 are those of -a, mirrored
+            const double v = std::copysign(rho, a);
+
+            for(int i=1;i<=pairs;i++)
+            {
+                const double W = i* 2*pi/N;
+                Complex zero = Complex(cos(W), sin(W));
+                result.add_conjugate_pair(v*zero, zero);
+            }
+
+            if (N & 1)
+                result.add_single(v, 1);
+            else // the zeros at DC and Nyquist share a biquad
+                result.add(ComplexPair(v, -v), ComplexPair(1, -1));
         }
+        else
+        {
+            // even N and a < 0: N/2 conjugate pole pairs, no real poles
+            for(int i=1;i<=pairs;i++)
+            {
+                const double W = i* 2*pi/N;
+                result.add_conjugate_pair(std::polar(rho, W + pi/N), Complex(cos(W), sin(W)));
+            }
 
-        if (N & 1)
-            result.add_single(v.real(), 1);
+            // the zeros at DC and Nyquist share a biquad with the poles at +-pi/N
+            const Complex pole = std::polar(rho, pi/N);
+            result.add(ComplexPair(pole, std::conj(pole)), ComplexPair(1, -1));
+        }
 
         result.set_normal(pi/N, 1.0);
 
@@ -114,38 +132,19 @@ namespace disiple {
 
         float fir_gain(Eigen::ArrayXf const& coeffs)
         {
-            using Pair    = std::pair<uint32_t, FFT>;
-            using Storage = std::vector<Pair>;
-
-            // avoid reallocations between runs
-            static std::mutex           mut;
-            static Eigen::ArrayXf       x;
-            static Eigen::ArrayXcf      z;
-            static Storage              ffts;
+            // plans are shared and buffers are cached per thread,
+            // avoiding reallocations between runs without locking
+            FFTRegistry& registry = FFTRegistry::local();
 
-            std::lock_guard<std::mutex> locker(mut);
-
-            uint32_t n = next_pow2((uint32_t)coeffs.size());
-            if ((uint32_t)x.size() != n) {
-                x.resize(n);
-                z.resize(n/2+1);
-            }
+            const uint32_t n = next_pow2((uint32_t)coeffs.size());
+            Eigen::ArrayXf&  x = registry.real_buffer(n);
+            Eigen::ArrayXcf& z = registry.complex_buffer(n/2+1);
 
             x.segment(0, coeffs.size()) = coeffs;
             x.segment(coeffs.size(), n - coeffs.size()).setZero();
 
-            // check if an fft of length n already exists
-            auto it = std::find_if(ffts.begin(), ffts.end(),
-                                   [n] (Pair const& p) { return p.first == n; });
-
-            // if not, construct it
-            if (it == ffts.end()) {
-                ffts.emplace_back(n, FFT(n));
-                it = std::prev(ffts.end());
-            }
-
             // perform fft
-            it->second(x, z);
+            registry.plan(n)(x, z);
 
             return z.abs().maxCoeff();
         }
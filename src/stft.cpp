@@ -0,0 +1,47 @@
+#include <disiple/stft.hpp>
+
+#include <stdexcept>
+
+namespace disiple {
+
+    STFT::STFT(const FIRWindow& window, int hop, FFTBackend backend)
+    : fft_(window.coeffs.size(), backend)
+    , window_(window.coeffs.reverse().cast<float>()) // coeffs run future -> past
+    , hop_(hop)
+    , pos_(0)
+    , countdown_(static_cast<int>(window.coeffs.size()))
+    {
+        if (hop < 1)
+            throw std::invalid_argument("stft: hop must be positive");
+    }
+
+    void STFT::initialize()
+    {
+        buf_.setZero();
+        pos_ = 0;
+        countdown_ = length();
+    }
+
+    void STFT::setup(int nchans)
+    {
+        if (buf_.rows() != nchans)
+        {
+            buf_.resize(nchans, length());
+            frame_.resize(nchans, length());
+            spec_.resize(nchans, num_bins());
+            initialize();
+        }
+    }
+
+    void STFT::transform_frame()
+    {
+        // unroll the ring buffer, the oldest sample is at pos_
+        const int len = length();
+        frame_.leftCols(len - pos_) = buf_.rightCols(len - pos_);
+        frame_.rightCols(pos_)      = buf_.leftCols(pos_);
+        frame_.rowwise() *= window_.transpose();
+
+        fft_.batch(frame_, spec_);
+    }
+
+}
@@ -0,0 +1,86 @@
+#include <disiple/welch.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace disiple {
+
+    using namespace Eigen;
+
+    Welch::Welch(const FIRWindow& window, int hop,
+                 WelchAveraging averaging, double alpha,
+                 bool cross_spectra, FFTBackend backend)
+    : stft_(window, hop, backend)
+    , averaging_(averaging)
+    , alpha_(alpha)
+    , cross_(cross_spectra)
+    , nseg_(0)
+    {
+        if (averaging == WelchAveraging::Exponential && (alpha <= 0.0 || alpha > 1.0))
+            throw std::invalid_argument("welch: alpha must be in (0,1]");
+
+        // |X|^2 / sum(w^2), doubled for all bins but DC and Nyquist
+        const int len = stft_.length();
+        scale_.setConstant(num_bins(), float(2.0 / stft_.window().square().sum()));
+        scale_[0] *= 0.5f;
+        if (len % 2 == 0)
+            scale_[len/2] *= 0.5f;
+    }
+
+    void Welch::initialize()
+    {
+        stft_.initialize();
+        psd_.setZero();
+        csd_.setZero();
+        nseg_ = 0;
+    }
+
+    void Welch::add_segment(const ArrayXXcf& spec)
+    {
+        const int nchans = static_cast<int>(spec.rows());
+        if (psd_.rows() != nchans)
+        {
+            psd_.setZero(nchans, num_bins());
+            if (cross_)
+                csd_.setZero(nchans * (nchans + 1) / 2, num_bins());
+            nseg_ = 0;
+        }
+
+        // the exponential mean is the running mean until 1/nseg drops below
+        // alpha, so that it starts from the first segment instead of zero
+        ++nseg_;
+        const float w = averaging_ == WelchAveraging::Running ? 1.0f / float(nseg_)
+                                                              : float(std::max(alpha_, 1.0 / nseg_));
+        const auto scale = scale_.transpose();
+
+        // mean += w * (periodogram - mean)
+        psd_ += w * ((spec.abs2().rowwise() * scale) - psd_);
+
+        if (cross_)
+            for (int i = 0; i < nchans; ++i)
+                for (int j = i; j < nchans; ++j)
+                {
+                    auto c = csd_.row(pair_index(i, j));
+                    c += w * ((spec.row(i).conjugate() * spec.row(j) * scale.cast<std::complex<float>>()) - c);
+                }
+    }
+
+    ArrayXcf Welch::csd(int i, int j) const
+    {
+        if (!cross_)
+            throw std::runtime_error("welch: cross spectra are not estimated");
+        if (i < 0 || j < 0 || i >= num_chans() || j >= num_chans())
+            throw std::invalid_argument("welch: channel out of range");
+
+        if (i <= j)
+            return csd_.row(pair_index(i, j)).transpose();
+        else
+            return csd_.row(pair_index(j, i)).transpose().conjugate();
+    }
+
+    ArrayXf Welch::coherence(int i, int j) const
+    {
+        return csd(i, j).abs2() / (psd_.row(i) * psd_.row(j)).transpose();
+    }
+
+}
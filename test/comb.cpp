@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/comb.hpp>
+#include <disiple/iir.hpp>
+
+using namespace Eigen;
+using namespace disiple;
+
+static const size_t nchan = 4;
+static const size_t ndata = 200;
+
+namespace {
+    template <typename Scalar> Scalar threshold();
+    template <> float  threshold<float>()  { return 1e-4f; }
+    template <> double threshold<double>() { return 1e-10; }
+}
+
+TEMPLATE_TEST_CASE_SIG("Comb filter", "[comb]",
+    ((typename Scalar, int NChan, bool DynLength), Scalar, NChan, DynLength),
+    (float,  Dynamic, true),  (double, Dynamic, true),
+    (float,  nchan,   true),  (double, nchan,   true),
+    (float,  Dynamic, false), (double, Dynamic, false),
+    (float,  nchan,   false), (double, nchan,   false)
+) {
+    enum { N = 5 };
+    const double BW = (50.0/125)/35;
+    using Filter = Comb<Scalar, Length<DynLength ? Dynamic : N>, Channels<NChan>>;
+
+    Array<Scalar, Dynamic, Dynamic> x = (ArrayXXd::Random(nchan, ndata) * 10).cast<Scalar>();
+    Array<Scalar, Dynamic, Dynamic> y(nchan, ndata), z(nchan, ndata);
+
+    // reference: the cascade of biquads designed by comb()
+    IIR<double, Channels<NChan>> ref(comb(N, BW));
+    ArrayXXd zd(nchan, ndata);
+    ref.apply(x.template cast<double>(), zd);
+    z = zd.cast<Scalar>();
+
+    SECTION("to_other", "Comb filter applied into another array") {
+        Filter f(N, BW);
+        f.apply(x.block(0,  0, nchan,       10), y.block(0,  0, nchan,       10));
+        f.apply(x.block(0, 10, nchan, ndata-10), y.block(0, 10, nchan, ndata-10));
+        REQUIRE( (z - y).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+
+    SECTION("update_only", "Comb filter state updated without applying it") {
+        Filter f(N, BW);
+        y = x;
+        f.apply(y.block(0,  0, nchan,       10), dry_run);
+        f.apply(y.block(0, 10, nchan, ndata-10));
+        REQUIRE( (x.block(0, 0, nchan, 10) - y.block(0, 0, nchan, 10)).abs().maxCoeff() == 0 );
+        REQUIRE( (z.block(0, 10, nchan, ndata-10) - y.block(0, 10, nchan, ndata-10)).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+
+    SECTION("init_nonzero", "Comb filter initialized to steady state rejects DC") {
+        Array<Scalar, Dynamic, 1> x0(nchan); x0 << 0, 50, 100, -100;
+        Filter f(N, BW);
+        f.initialize(x0);
+        f.apply(x.colwise() + x0, y);
+        REQUIRE( (z - y).abs().maxCoeff() <= threshold<Scalar>() * 10 );
+    }
+}
+
+TEST_CASE("Comb filter with long delay", "[comb]")
+{
+    const int N = 100;
+    const double BW = .002;
+
+    Comb<double> f(N, BW);
+    IIR<double> ref(comb(N, BW));
+
+    ArrayXXd x = ArrayXXd::Random(1, 1000), y(1, 1000), z(1, 1000);
+    f.apply(x, y);
+    ref.apply(x, z);
+    REQUIRE( (z - y).abs().maxCoeff() <= 1e-8 );
+}
+
+TEST_CASE("Default constructed comb filter", "[comb]")
+{
+    // length 1 without notch bandwidth: the first difference
+    Comb<double> f;
+    ArrayXXd x = ArrayXXd::Random(1, 50), y(1, 50);
+    f.apply(x, y);
+    REQUIRE( (y.col(0) - x.col(0)).abs().maxCoeff() == 0 );
+    REQUIRE( (y.rightCols(49) - (x.rightCols(49) - x.leftCols(49))).abs().maxCoeff() <= 1e-15 );
+}
+
+TEST_CASE("Comb filter with wide notches", "[comb]")
+{
+    // N*BW > 1 makes the pole factor 2*gain-1 negative
+    for (int N : { 4, 5, 6 })
+    {
+        const double BW = 1.5 / N;
+
+        Comb<double> f(N, BW);
+        IIR<double> ref(comb(N, BW));
+
+        ArrayXXd x = ArrayXXd::Random(1, 500), y(1, 500), z(1, 500);
+        f.apply(x, y);
+        ref.apply(x, z);
+        REQUIRE( (z - y).abs().maxCoeff() <= 1e-10 );
+    }
+}
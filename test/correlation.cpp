@@ -0,0 +1,97 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/correlation.hpp>
+#include <vector>
+
+using namespace Eigen;
+using namespace disiple;
+
+namespace {
+
+    // direct O(n * lags) reference
+    ArrayXd direct_xcorr(const ArrayXf& x, const ArrayXf& y, int max_lag)
+    {
+        const int n = int(x.size());
+        ArrayXd r = ArrayXd::Zero(2*max_lag+1);
+        for (int l = -max_lag; l <= max_lag; ++l)
+            for (int t = std::max(0, -l); t < std::min(n, n-l); ++t)
+                r[l+max_lag] += double(x[t+l]) * double(y[t]);
+        return r;
+    }
+
+    float rel_error(const ArrayXf& a, const ArrayXd& b)
+    {
+        return float((a.cast<double>() - b).abs().maxCoeff() / b.abs().maxCoeff());
+    }
+
+}
+
+TEST_CASE("Cross-correlation of two signals", "[correlation]")
+{
+    const int n = 1000, max_lag = 100;
+    ArrayXf x = ArrayXf::Random(n), y = ArrayXf::Random(n);
+    const ArrayXd ref = direct_xcorr(x, y, max_lag);
+
+    REQUIRE( rel_error(xcorr(x, y, max_lag), ref) <= 1e-5f );
+    REQUIRE( rel_error(xcorr(x, y, max_lag, CorrelationScaling::Biased), ref / n) <= 1e-5f );
+
+    ArrayXd unbiased = ref;
+    for (int l = -max_lag; l <= max_lag; ++l)
+        unbiased[l+max_lag] /= n - std::abs(l);
+    REQUIRE( rel_error(xcorr(x, y, max_lag, CorrelationScaling::Unbiased), unbiased) <= 1e-5f );
+
+    // a delayed copy has a coefficient of almost 1 at minus the delay
+    const int d = 17;
+    ArrayXf z = ArrayXf::Zero(n);
+    z.tail(n-d) = x.head(n-d);
+    ArrayXf r = xcorr(x, z, max_lag, CorrelationScaling::Coefficient);
+    Index imax;
+    r.maxCoeff(&imax);
+    REQUIRE( imax - max_lag == -d );
+    REQUIRE( r[imax] > 0.95f );
+    REQUIRE( r[imax] <= 1.0f + 1e-5f );
+
+    REQUIRE_THROWS_AS( xcorr(x, ArrayXf(x.head(10)), 5), std::invalid_argument );
+    REQUIRE_THROWS_AS( xcorr(x, y, n), std::invalid_argument );
+}
+
+TEST_CASE("Correlation of channel pairs", "[correlation]")
+{
+    const int nchan = 4, n = 777, max_lag = 50;
+    ArrayXXf x = ArrayXXf::Random(nchan, n);
+
+    const std::vector<ChannelPair> pairs = { {0, 1}, {2, 3}, {3, 2}, {1, 1} };
+    ArrayXXf r = xcorr(x, pairs, max_lag);
+    REQUIRE( r.rows() == 4 );
+    REQUIRE( r.cols() == 2*max_lag+1 );
+
+    for (size_t p = 0; p < pairs.size(); ++p)
+        REQUIRE( rel_error(r.row(p).transpose(),
+                           direct_xcorr(x.row(pairs[p].first).transpose(),
+                                        x.row(pairs[p].second).transpose(), max_lag)) <= 1e-5f );
+
+    ArrayXXf a = autocorr(x, max_lag, CorrelationScaling::Coefficient);
+    REQUIRE( a.rows() == nchan );
+    REQUIRE( a.cols() == max_lag+1 );
+    REQUIRE( (a.col(0) - 1).abs().maxCoeff() <= 1e-5f );
+    REQUIRE( a.rightCols(max_lag).abs().maxCoeff() < 0.2f );
+}
+
+TEST_CASE("Sliding window correlation", "[correlation]")
+{
+    const int nchan = 3, n = 2000, window = 500, max_lag = 40, hop = 150;
+    ArrayXXf x = ArrayXXf::Random(nchan, n);
+    const std::vector<ChannelPair> pairs = { {0, 1}, {2, 2} };
+
+    SlidingCorrelation sc(window, max_lag, hop, pairs, CorrelationScaling::Unbiased);
+
+    std::vector<ArrayXXf> results;
+    for (int t = 0; t < n; t += 64)
+        sc.apply(x.middleCols(t, std::min(64, n-t)), [&](const ArrayXXf& r) { results.push_back(r); });
+
+    const int nwin = 1 + (n - window) / hop;
+    REQUIRE( int(results.size()) == nwin );
+    for (int k = 0; k < nwin; ++k) {
+        ArrayXXf ref = xcorr(x.middleCols(k*hop, window), pairs, max_lag, CorrelationScaling::Unbiased);
+        REQUIRE( (results[k] - ref).abs().maxCoeff() <= 1e-6f );
+    }
+}
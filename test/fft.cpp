@@ -0,0 +1,176 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/fft.hpp>
+#include <thread>
+#include <vector>
+
+using namespace Eigen;
+using namespace disiple;
+
+namespace {
+
+    // naive O(n^2) dft as reference
+    ArrayXcd dft(const ArrayXcd& x, double sign = -1)
+    {
+        const Index n = x.size();
+        ArrayXcd y(n);
+        for (Index k = 0; k < n; ++k) {
+            std::complex<double> s = 0;
+            for (Index t = 0; t < n; ++t)
+                s += x[t] * std::polar(1.0, sign * 2 * M_PI * double((k * t) % n) / double(n));
+            y[k] = s;
+        }
+        return y;
+    }
+
+    float rel_error(const ArrayXcf& a, const ArrayXcd& b)
+    {
+        return float((a.cast<std::complex<double>>() - b).abs().maxCoeff() / b.abs().maxCoeff());
+    }
+
+}
+
+TEST_CASE("FFT of real and complex data", "[fft]")
+{
+    for (size_t n : { 2, 8, 64, 1024 })
+    {
+        FFT fft(n);
+        REQUIRE( fft.length() == n );
+
+        ArrayXf  x = ArrayXf::Random(n);
+        ArrayXcf cx = ArrayXcf::Random(n);
+        ArrayXcd ref  = dft(x.cast<std::complex<double>>());
+        ArrayXcd cref = dft(cx.cast<std::complex<double>>());
+
+        ArrayXcf y(n/2+1), cy(n);
+        fft(x, y);
+        REQUIRE( rel_error(y, ref.head(n/2+1)) <= 1e-5f );
+
+        fft.complex_forward(cx, cy);
+        REQUIRE( rel_error(cy, cref) <= 1e-5f );
+
+        ArrayXf  xi(n);
+        ArrayXcf cxi(n);
+        fft.inverse(y, xi);
+        fft.complex_inverse(cy, cxi);
+        REQUIRE( (x - xi).abs().maxCoeff() <= 1e-5f );
+        REQUIRE( (cx - cxi).abs().maxCoeff() <= 1e-5f );
+    }
+
+    FFT fft8(8);
+    ArrayXf  x7(7);
+    ArrayXcf y5(5);
+    REQUIRE_THROWS( fft8(x7, y5) );
+}
+
+TEST_CASE("FFT of arbitrary length", "[fft]")
+{
+    // mixed radix, prime and lengths handled by Bluestein's algorithm
+    for (size_t n : { 15, 97, 1000, 2000 })
+    {
+        FFT fft(n);
+
+        ArrayXf  x = ArrayXf::Random(n);
+        ArrayXcf cx = ArrayXcf::Random(n);
+        ArrayXcd ref  = dft(x.cast<std::complex<double>>());
+        ArrayXcd cref = dft(cx.cast<std::complex<double>>());
+
+        ArrayXcf y(n/2+1), cy(n);
+        fft(x, y);
+        REQUIRE( rel_error(y, ref.head(n/2+1)) <= 1e-5f );
+
+        fft.complex_forward(cx, cy);
+        REQUIRE( rel_error(cy, cref) <= 1e-5f );
+
+        ArrayXf  xi(n);
+        ArrayXcf cxi(n);
+        fft.inverse(y, xi);
+        fft.complex_inverse(cy, cxi);
+        REQUIRE( (x - xi).abs().maxCoeff() <= 1e-4f );
+        REQUIRE( (cx - cxi).abs().maxCoeff() <= 1e-4f );
+    }
+
+    REQUIRE( fft_fast_length(1024) == 1024 );
+    REQUIRE( fft_fast_length(1000) >= 1000 );
+    REQUIRE( fft_fast_length(97) > 97 );
+}
+
+TEST_CASE("FFT backends", "[fft]")
+{
+    REQUIRE( fft_backend_available(FFTBackend::Default) );
+    REQUIRE( fft_backend_available(FFTBackend::Eigen) );
+    REQUIRE( FFT(64).backend() != FFTBackend::Default );
+
+    for (FFTBackend b : { FFTBackend::Eigen, FFTBackend::PFFFT, FFTBackend::Accelerate })
+    {
+        if (!fft_backend_available(b)) {
+            REQUIRE_THROWS_AS( FFT(64, b), std::invalid_argument );
+            continue;
+        }
+
+        for (size_t n : { 64, 1000 })
+        {
+            FFT fft(n, b);
+            REQUIRE( fft.backend() == b );
+
+            ArrayXf  x = ArrayXf::Random(n), xi(n);
+            ArrayXcf y(n/2+1);
+            fft(x, y);
+            REQUIRE( rel_error(y, dft(x.cast<std::complex<double>>()).head(n/2+1)) <= 1e-5f );
+
+            fft.inverse(y, xi);
+            REQUIRE( (x - xi).abs().maxCoeff() <= 1e-4f );
+        }
+    }
+}
+
+TEST_CASE("Batched FFT of multichannel data", "[fft]")
+{
+    const size_t n = 256, nchan = 16;
+    FFT fft(n);
+
+    ArrayXXf  x = ArrayXXf::Random(nchan, n), xi(nchan, n);
+    ArrayXXcf y(nchan, n/2+1);
+    ArrayXcf  yc(n/2+1);
+
+    fft.batch(x, y);
+    for (size_t c = 0; c < nchan; ++c) {
+        fft(x.row(c).transpose(), yc);
+        REQUIRE( (y.row(c).transpose() - yc).abs().maxCoeff() == 0 );
+    }
+
+    fft.batch_inverse(y, xi);
+    REQUIRE( (x - xi).abs().maxCoeff() <= 1e-5f );
+}
+
+TEST_CASE("FFT shared between threads", "[fft]")
+{
+    const int nthreads = 4, nruns = 100;
+    const size_t n = 512;
+
+    const FFT& fft = FFTRegistry::local().plan(n);
+    ArrayXf  x = ArrayXf::Random(n);
+    ArrayXcf ref(n/2+1);
+    fft(x, ref);
+
+    std::vector<std::thread> threads;
+    std::vector<float> maxdev(nthreads, 0.f);
+    std::vector<const FFT*> plans(nthreads);
+
+    for (int t=0; t<nthreads; ++t)
+        threads.emplace_back([&, t] {
+            plans[t] = &FFTRegistry::local().plan(n);
+            ArrayXcf y(n/2+1);
+            for (int i=0; i<nruns; ++i) {
+                fft(x, y);
+                maxdev[t] = std::max(maxdev[t], (y - ref).abs().maxCoeff());
+            }
+        });
+
+    for (auto& t : threads)
+        t.join();
+
+    for (int t=0; t<nthreads; ++t) {
+        REQUIRE( maxdev[t] == 0 );
+        REQUIRE( plans[t] == &fft );
+    }
+}
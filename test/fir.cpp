@@ -1,6 +1,8 @@
 #include <catch2/catch_all.hpp>
 #include <disiple/fir.hpp>
 #include <type_traits>
+#include <thread>
+#include <vector>
 
 using namespace Eigen;
 using namespace disiple;
@@ -185,3 +187,28 @@ TEMPLATE_TEST_CASE_SIG("FIR filter with designed with an asymmetric Blackman win
     }
 }
 
+
+TEST_CASE("FIR filters designed concurrently", "[fir]")
+{
+    const int nthreads = 4, ndesigns = 50;
+
+    FIRWindow window = hamming(20, 40);
+    FIRDesign ref(window, Bandpass(.1, .3));
+
+    std::vector<std::thread> threads;
+    std::vector<float> maxdev(nthreads, 0.f);
+
+    for (int t=0; t<nthreads; ++t)
+        threads.emplace_back([&, t] {
+            for (int i=0; i<ndesigns; ++i) {
+                FIRDesign d(window, Bandpass(.1, .3));
+                maxdev[t] = std::max(maxdev[t], (d.coeffs - ref.coeffs).abs().maxCoeff());
+            }
+        });
+
+    for (auto& t : threads)
+        t.join();
+
+    for (float m : maxdev)
+        REQUIRE( m == 0 );
+}
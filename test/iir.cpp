@@ -268,4 +268,39 @@ TEST_CASE("IIR filter response", "[iir]")
     sos.response(f, z);
     REQUIRE( (resp_real - z.real()).abs().maxCoeff() <= 1e-10 );
     REQUIRE( (resp_imag - z.imag()).abs().maxCoeff() <= 1e-10 );
-}
\ No newline at end of file
+}
+
+TEMPLATE_TEST_CASE_SIG("IIR filter designed at compile time", "[iir]",
+    ((typename Scalar, IIRImplementation Type), Scalar, Type),
+    (float,  DF1), (float,  DF2), (float,  DF2T),
+    (double, DF1), (double, DF2), (double, DF2T)
+) {
+    const TestFixtureIIR<Scalar> fix;
+    Array<Scalar, Dynamic, Dynamic> y(nchan, ndata);
+    using Filter = IIR<Scalar, Stages<2>, Implementation<Type>, Channels<nchan>>;
+
+    constexpr auto slp = butterworth_lowpass <Scalar, 3>(.1);
+    constexpr auto shp = butterworth_highpass<Scalar, 3>(.2);
+
+    STATIC_REQUIRE( slp.num_stages() == 2 );
+    STATIC_REQUIRE( slp.coeffs[0][0] == Scalar(2) );
+    STATIC_REQUIRE( shp.coeffs[0][0] == Scalar(-2) );
+
+    // same coefficients as the runtime design
+    SecondOrderSections<Scalar, 2> dlp(fix.dlp), clp(slp);
+    SecondOrderSections<Scalar, 2> dhp(fix.dhp), chp(shp);
+    for (int i=0; i<2; ++i) {
+        REQUIRE( (dlp.coeffs(i) - clp.coeffs(i)).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (dhp.coeffs(i) - chp.coeffs(i)).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+    REQUIRE( std::abs(dlp.scaling() - clp.scaling()) <= threshold<Scalar>() );
+    REQUIRE( std::abs(dhp.scaling() - chp.scaling()) <= threshold<Scalar>() );
+
+    Filter flp(slp);
+    flp.apply(fix.raw_data, y);
+    REQUIRE( (fix.mlp_data - y).abs().maxCoeff() <= threshold<Scalar>() );
+
+    Filter fhp(shp);
+    fhp.apply(fix.raw_data, y);
+    REQUIRE( (fix.mhp_data - y).abs().maxCoeff() <= threshold<Scalar>() );
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/morphology.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+using namespace Eigen;
+using namespace disiple;
+
+static const size_t nchan = 4;
+
+namespace {
+
+    // centered erosion or dilation, the element clipped at both ends
+    ArrayXXd reference(const ArrayXXd& x, int len, bool dilate)
+    {
+        const int h = (len-1) / 2, n = int(x.cols());
+        ArrayXXd y(x.rows(), n);
+        for (int i=0; i<n; ++i) {
+            const int b = std::max(0, i-h), e = std::min(n-1, i+h);
+            if (dilate)
+                y.col(i) = x.middleCols(b, e-b+1).rowwise().maxCoeff();
+            else
+                y.col(i) = x.middleCols(b, e-b+1).rowwise().minCoeff();
+        }
+        return y;
+    }
+
+}
+
+TEMPLATE_TEST_CASE_SIG("Morphological Filters", "[morphology]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, Dynamic), (int, Dynamic),
+    (unsigned char, Dynamic),
+    (float, nchan),   (int, nchan),   (uint16_t, nchan)
+) {
+    const int N = 200;
+
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    // extreme values must not overflow, e.g. by negation
+    data(0, N/2)   = std::numeric_limits<Scalar>::lowest();
+    data(1, N/2+5) = std::numeric_limits<Scalar>::max();
+    const ArrayXXd dd = data.template cast<double>();
+    Array<Scalar, NChan, Dynamic> y(nchan, N);
+
+    for (int L : { 1, 3, 11, 31 })
+    {
+        const ArrayXXd ero = reference(dd, L, false), dil = reference(dd, L, true);
+        const ArrayXXd opened = reference(ero, L, true), closed = reference(dil, L, false);
+        const ArrayXXd refs[] = { ero, dil, opened, closed,
+                                  reference(reference(opened, L, true), L, false),
+                                  reference(reference(closed, L, false), L, true) };
+
+        Erosion <Scalar, Channels<NChan>> fero(L);
+        Dilation<Scalar, Channels<NChan>> fdil(L);
+        Opening <Scalar, Channels<NChan>> fopen(L);
+        Closing <Scalar, Channels<NChan>> fclose(L);
+        OpenClose<Scalar, Channels<NChan>> foc(L);
+        CloseOpen<Scalar, Channels<NChan>> fco(L);
+
+        REQUIRE( fero.delay()   == (L-1)/2 );
+        REQUIRE( fopen.delay()  == L-1 );
+        REQUIRE( fclose.delay() == L-1 );
+        REQUIRE( foc.delay()    == 2*(L-1) );
+        REQUIRE( fco.delay()    == 2*(L-1) );
+
+        for (int k = 0; k < 6; ++k)
+        {
+            int d = 0;
+            switch (k) {
+                case 0: fero.apply(data, y);   d = fero.delay();   break;
+                case 1: fdil.apply(data, y);   d = fdil.delay();   break;
+                case 2: fopen.apply(data, y);  d = fopen.delay();  break;
+                case 3: fclose.apply(data, y); d = fclose.delay(); break;
+                case 4: foc.apply(data, y);    d = foc.delay();    break;
+                case 5: fco.apply(data, y);    d = fco.delay();    break;
+            }
+
+            // the output lags the centered result by the delay
+            REQUIRE( (y.rightCols(N-d).template cast<double>() - refs[k].leftCols(N-d)).abs().maxCoeff() == 0 );
+        }
+    }
+
+    // opening never exceeds the signal, closing never falls below it
+    Opening<Scalar, Channels<NChan>> fopen(9);
+    Closing<Scalar, Channels<NChan>> fclose(9);
+    fopen.apply(data, y);
+    REQUIRE( (y.rightCols(N-8) <= data.leftCols(N-8)).all() );
+    fclose.apply(data, y);
+    REQUIRE( (y.rightCols(N-8) >= data.leftCols(N-8)).all() );
+
+    REQUIRE_THROWS_AS( Opening<Scalar>(10), std::invalid_argument );
+}
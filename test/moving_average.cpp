@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 #include <disiple/moving_average.hpp>
+#include <vector>
 
 using namespace Eigen;
 using namespace disiple;
@@ -46,3 +47,187 @@ TEMPLATE_TEST_CASE_SIG("Moving Average Filter", "[running_stats]",
         REQUIRE( (y2 - y3).abs().maxCoeff() <= threshold<Scalar>() );
     }
 }
+
+TEMPLATE_TEST_CASE_SIG("Moving Average summation modes", "[running_stats]",
+    ((typename Scalar, SummationMode Mode), Scalar, Mode),
+    (float, Plain), (float, Resync), (float, Compensated),
+    (double, Compensated), (int, Plain), (int, Compensated)
+) {
+    const int W = 10;
+
+    MovingAverage<Scalar, Stages<2>, Channels<nchan>, Summation<Mode>> rmean(W);
+    MovingAverage<Scalar, Stages<1>, Channels<nchan>, Summation<Mode>> rmean1(W), rmean2(W);
+
+    Array<Scalar, nchan, Dynamic> data = (ArrayXXf::Random(nchan, 97) * 10 + 20).cast<Scalar>();
+    Array<Scalar, nchan, 1> y, y1, y2, z;
+
+    for (int i=0; i<data.cols(); ++i)
+    {
+        auto block = i<W ? data.block(0,     0, nchan, i+1)
+                         : data.block(0, i-W+1, nchan,   W);
+        z = block.rowwise().mean();
+
+        rmean1.apply(data.col(i), y1);
+        REQUIRE( (z - y1).abs().maxCoeff() <= threshold<Scalar>() );
+
+        rmean2.apply(y1, y2);
+        rmean.apply(data.col(i), y);
+        REQUIRE( (y - y2).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+}
+
+TEST_CASE("Moving Average drift over long runs", "[running_stats]")
+{
+    const int W = 2000, N = 200000;
+
+    // a large offset makes rounding errors of the running sum visible
+    ArrayXXf data = ArrayXXf::Random(1, N) + 1000;
+
+    MovingAverage<float, Summation<Plain>>       plain(W);
+    MovingAverage<float, Summation<Resync>>      resync(W);
+    MovingAverage<float, Summation<Compensated>> compensated(W);
+    ArrayXXf yp(1, N), yr(1, N), yc(1, N);
+    plain.apply(data, yp);
+    resync.apply(data, yr);
+    compensated.apply(data, yc);
+
+    // exact reference
+    ArrayXd cum(N+1);
+    cum[0] = 0;
+    for (int i=0; i<N; ++i)
+        cum[i+1] = cum[i] + double(data(0, i));
+    ArrayXXd ref = (cum.tail(N-W) - cum.segment(1, N-W)).transpose() / W;
+
+    const double ep = (yp.rightCols(N-W).cast<double>() - ref).abs().maxCoeff();
+    const double er = (yr.rightCols(N-W).cast<double>() - ref).abs().maxCoeff();
+    const double ec = (yc.rightCols(N-W).cast<double>() - ref).abs().maxCoeff();
+
+    // compensated sums are as accurate as the float output allows
+    REQUIRE( ec <= 1e-4 );
+    REQUIRE( ec <= er );
+    REQUIRE( ec <= ep );
+}
+
+TEMPLATE_TEST_CASE_SIG("Multi-length Moving Average", "[running_stats]",
+    ((typename Scalar, int NChan, SummationMode Mode), Scalar, NChan, Mode),
+    (float, Dynamic, Resync), (double, nchan, Resync),
+    (float, nchan, Compensated), (int, Dynamic, Plain)
+) {
+    const std::vector<int> lengths = { 3, 10, 1, 7 };
+
+    MultiMovingAverage<Scalar, Channels<NChan>, Summation<Mode>> multi(lengths);
+    REQUIRE( multi.num_lengths() == 4 );
+
+    Array<Scalar, Dynamic, Dynamic> data = (ArrayXXf::Random(nchan, 97) * 10 + 20).cast<Scalar>();
+    Array<Scalar, Dynamic, Dynamic> y(lengths.size() * nchan, 97), z(nchan, 97);
+
+    multi.apply(data.leftCols(40), y.leftCols(40));
+    multi.apply(data.rightCols(57), y.rightCols(57));
+
+    // same as separate moving averages
+    for (size_t k = 0; k < lengths.size(); ++k)
+    {
+        MovingAverage<Scalar, Channels<NChan>, Summation<Mode>> single(lengths[k]);
+        single.apply(data, z);
+        REQUIRE( (y.middleRows(k * nchan, nchan) - z).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+
+    Array<Scalar, Dynamic, Dynamic> wrong(nchan, 97);
+    REQUIRE_THROWS_AS( multi.apply(data, wrong), std::invalid_argument );
+}
+
+TEMPLATE_TEST_CASE_SIG("Exponential Moving Average and Variance", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, Dynamic), (float, nchan), (double, nchan)
+) {
+    const double alpha = 0.05;
+    const int N = 300;
+
+    Array<Scalar, Dynamic, Dynamic> data = (ArrayXXd::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    Array<Scalar, Dynamic, Dynamic> m(nchan, N), v(nchan, N);
+
+    ExpMovingAverage <Scalar, Channels<NChan>> ema(alpha);
+    ExpMovingVariance<Scalar, Channels<NChan>> emv(alpha);
+    ema.apply(data, m);
+    emv.apply(data, v);
+
+    // reference: explicitly weighted sums, the first sample seeds the mean
+    ArrayXd rm = data.col(0).template cast<double>(), rv = ArrayXd::Zero(nchan);
+    for (int t = 1; t < N; ++t) {
+        const ArrayXd x = data.col(t).template cast<double>();
+        rv = (1 - alpha) * (rv + alpha * (x - rm).square());
+        rm += alpha * (x - rm);
+        REQUIRE( (m.col(t).template cast<double>() - rm).abs().maxCoeff() <= 1e-4 );
+        REQUIRE( (v.col(t).template cast<double>() - rv).abs().maxCoeff() <= 1e-3 );
+    }
+
+    SECTION("block", "Closed form update of whole blocks") {
+        ExpMovingVariance<Scalar, Channels<NChan>> blk(alpha);
+        blk.apply(data.leftCols(1), dry_run);
+        blk.apply(data.middleCols(1, 100), dry_run);
+        blk.apply(data.rightCols(N-101), dry_run);
+        REQUIRE( (blk.mean().template cast<double>() - rm).abs().maxCoeff() <= 1e-4 );
+        REQUIRE( (blk.variance().template cast<double>() - rv).abs().maxCoeff() <= 1e-3 );
+        REQUIRE( (emv.mean() - blk.mean()).abs().maxCoeff() <= Scalar(1e-4) );
+
+        ExpMovingAverage<Scalar, Channels<NChan>> blk_mean(alpha);
+        blk_mean.apply(data, dry_run);
+        REQUIRE( (blk_mean.mean().template cast<double>() - rm).abs().maxCoeff() <= 1e-4 );
+    }
+
+    SECTION("init_nonzero", "Initialized to steady state") {
+        Array<Scalar, Dynamic, 1> x0 = data.col(0);
+        ExpMovingAverage<Scalar, Channels<NChan>> f(alpha);
+        f.initialize(x0);
+        Array<Scalar, Dynamic, Dynamic> y(nchan, N), z = data.col(0).replicate(1, N);
+        f.apply(z, y);
+        REQUIRE( (y - z).abs().maxCoeff() <= threshold<Scalar>() * 100 );
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG("Cumulative Statistics", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, Dynamic), (float, nchan), (double, nchan)
+) {
+    const int N = 1000;
+
+    Array<Scalar, Dynamic, Dynamic> data = (ArrayXXd::Random(nchan, N) * 10 + 1000).cast<Scalar>();
+    const ArrayXXd dd = data.template cast<double>();
+
+    const ArrayXd mean = dd.rowwise().mean();
+    const ArrayXd var  = (dd.colwise() - mean).square().rowwise().mean();
+    const double tol = std::is_same<Scalar, float>::value ? 1e-3 : 1e-9;
+
+    auto check = [&](const CumStatistics<Scalar, Channels<NChan>>& s) {
+        REQUIRE( s.count() == N );
+        REQUIRE( (s.mean().template cast<double>() - mean).abs().maxCoeff() <= tol * 1000 );
+        REQUIRE( (s.variance().template cast<double>() - var).abs().maxCoeff() <= tol * 100 );
+        REQUIRE( (s.min() - data.rowwise().minCoeff()).abs().maxCoeff() == 0 );
+        REQUIRE( (s.max() - data.rowwise().maxCoeff()).abs().maxCoeff() == 0 );
+    };
+
+    SECTION("per_sample", "Welford updates, the output is the running mean") {
+        CumStatistics<Scalar, Channels<NChan>> s;
+        Array<Scalar, Dynamic, Dynamic> y(nchan, N);
+        s.apply(data, y);
+        check(s);
+        REQUIRE( (y.col(0) - data.col(0)).abs().maxCoeff() == 0 );
+        REQUIRE( (y.col(9).template cast<double>() - dd.leftCols(10).rowwise().mean()).abs().maxCoeff() <= tol * 1000 );
+    }
+
+    SECTION("merged", "Blocks processed separately and merged") {
+        CumStatistics<Scalar, Channels<NChan>> a, b, c, empty;
+        a.apply(data.leftCols(100), dry_run);
+        b.apply(data.middleCols(100, 650), dry_run);
+        for (int t = 750; t < N; ++t)
+            c.apply(data.col(t), dry_run);
+
+        a.merge(empty);
+        a.merge(b);
+        a.merge(c);
+        check(a);
+
+        empty.merge(a);
+        check(empty);
+    }
+}
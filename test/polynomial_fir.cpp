@@ -1,6 +1,8 @@
 #include <catch2/catch_all.hpp>
 #include <disiple/fir.hpp>
 #include <disiple/polynomial_fir.hpp>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <Eigen/Cholesky>
 
@@ -70,6 +72,125 @@ TEMPLATE_TEST_CASE("Polynomial FIR filter", "[fir_poly]", float, double)
                          z.block(0,wlen,nchan,ndata-wlen)).abs().maxCoeff(); 
         
         REQUIRE( maxdev <= threshold<Scalar>() );
+
+        // the precomputed warm-up table matches the rational polynomials
+        Array<Scalar, 2, 1> a;
+        for (int n = 1; n <= int(wlen); ++n) {
+            p.coeffs().update(Scalar(n), a);
+            REQUIRE( (p.coeffs().weights(n) - a).abs().maxCoeff() == 0 );
+        }
+
+        // a copy shares the table, a restarted filter repeats its warm-up
+        PolynomialFIR<Scalar, 2, 2, 4, Channels<nchan>> copy = p;
+        REQUIRE( copy.coeffs().table_ == p.coeffs().table_ );
+        copy.initialize();
+        Array<Scalar, nchan, Dynamic> w(nchan, ndata);
+        copy.apply(raw_data, w);
+        REQUIRE( (w - z).abs().maxCoeff() == 0 );
+    }
+
+}
+
+TEST_CASE("Polynomial FIR drift over long runs", "[fir_poly]")
+{
+    const int W = 500, N = 200000;
+
+    // slope of a least squares line fit, as above
+    Array<double, 2, 2> P;
+    Array<double, 2, 4> Q;
+    P <<   6, 6,
+         -12, 0;
+    Q << 0, -1, 0, 1,
+         0, -1, 0, 1;
+
+    // a large offset makes rounding errors of the recursive sums visible
+    ArrayXXf data = ArrayXXf::Random(1, N) + 1000;
+
+    PolynomialFIR<double, 2, 2, 4>                        exact(P, Q, W);
+    PolynomialFIR<float,  2, 2, 4, Summation<Plain>>       plain(P.cast<float>(), Q.cast<float>(), W);
+    PolynomialFIR<float,  2, 2, 4, Summation<Resync>>      resync(P.cast<float>(), Q.cast<float>(), W);
+    PolynomialFIR<float,  2, 2, 4, Summation<Compensated>> compensated(P.cast<float>(), Q.cast<float>(), W);
+
+    ArrayXXd ref(1, N);
+    ArrayXXf yp(1, N), yr(1, N), yc(1, N);
+    exact.apply(data.cast<double>(), ref);
+    plain.apply(data, yp);
+    resync.apply(data, yr);
+    compensated.apply(data, yc);
+
+    const double ep = (yp.rightCols(N-W).cast<double>() - ref.rightCols(N-W)).abs().maxCoeff();
+    const double er = (yr.rightCols(N-W).cast<double>() - ref.rightCols(N-W)).abs().maxCoeff();
+    const double ec = (yc.rightCols(N-W).cast<double>() - ref.rightCols(N-W)).abs().maxCoeff();
+
+    // both drift-free modes stay well below the drift of the plain sums
+    REQUIRE( er <= 3e-4 );
+    REQUIRE( ec <= 1e-4 );
+    REQUIRE( er * 4 <= ep );
+    REQUIRE( ec * 4 <= ep );
+}
+
+TEST_CASE("Default constructed polynomial FIR filter", "[fir_poly]")
+{
+    // all weights zero, with the static or a unit window length
+    PolynomialFIR<double, 2, 2, 4, Length<8>> f;
+    PolynomialFIR<double, 2, 2, 4>            g;
+    REQUIRE( f.coeffs().length() == 8 );
+    REQUIRE( g.coeffs().length() == 1 );
+
+    ArrayXXd x = ArrayXXd::Random(1, 20), y(1, 20), z(1, 20);
+    f.apply(x, y);
+    g.apply(x, z);
+    REQUIRE( (y == 0).all() );
+    REQUIRE( (z == 0).all() );
+}
+
+TEMPLATE_TEST_CASE_SIG("Polynomial FIR filter of higher order", "[fir_poly]",
+    ((SummationMode Mode), Mode), Plain, Resync, Compensated)
+{
+    const int L = 8, N = 100;
+
+    // weights w_t = sum_i a_i(n) t^i, t = 1 for the newest sample, with
+    // a(n) linear in the number n of samples in the window
+    Array<double, 4, 2> P;
+    Array<double, 4, 1> Q = Array<double, 4, 1>::Ones();
+    P << 0.5,  0.1,
+        -1.0,  0.0,
+         0.3,  0.2,
+         0.0, -0.01;
+    auto a = [&](int n) { Array<double, 4, 1> r = P.col(0) + P.col(1) * double(n); return r; };
+
+    // direct evaluation, including the warm-up
+    auto direct = [&](const ArrayXXd& x, int I) {
+        ArrayXXd y = ArrayXXd::Zero(1, x.cols());
+        for (int t = 0; t < x.cols(); ++t) {
+            const int n = std::min(t + 1, L);
+            for (int k = 0; k < n; ++k)
+                for (int i = 0; i < I; ++i)
+                    y(0, t) += a(n)[i] * std::pow(double(k + 1), i) * x(0, t - k);
+        }
+        return y;
+    };
+
+    PolynomialFIR<double, 3, 2, 1, Summation<Mode>> f3(P.topRows(3), Q.topRows(3), L);
+    PolynomialFIR<double, 4, 2, 1, Summation<Mode>> f4(P, Q, L);
+
+    SECTION("constant input")
+    {
+        // w_t = t^2 sums to 204 over a full window, without drifting
+        Array<double, 3, 2> P2 = Array<double, 3, 2>::Zero();
+        P2(2, 0) = 1;
+        PolynomialFIR<double, 3, 2, 1, Summation<Mode>> sq(P2, Q.topRows(3), L);
+        ArrayXXd y(1, N);
+        sq.apply(ArrayXXd::Ones(1, N), y);
+        REQUIRE( (y.rightCols(N-L+1) - 204).abs().maxCoeff() <= 1e-12 );
     }
 
+    SECTION("random input")
+    {
+        ArrayXXd x = ArrayXXd::Random(1, N), y3(1, N), y4(1, N);
+        f3.apply(x, y3);
+        f4.apply(x, y4);
+        REQUIRE( (y3 - direct(x, 3)).abs().maxCoeff() <= 1e-11 );
+        REQUIRE( (y4 - direct(x, 4)).abs().maxCoeff() <= 1e-10 );
+    }
 }
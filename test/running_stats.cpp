@@ -1,5 +1,8 @@
 #include <catch2/catch_all.hpp>
 #include <disiple/running_statistics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 using namespace Eigen;
 using namespace disiple;
@@ -23,8 +26,8 @@ TEMPLATE_TEST_CASE_SIG("Running Min, Max and Range", "[running_stats]",
     const int W = 10; // Window length of the filter
 
     disiple::RunningMin  <Scalar, Channels<NChan>> fmin(W);
-    // disiple::RunningMax  <Scalar, Channels<NChan>> fmax(W);
-    // disiple::RunningRange<Scalar, Channels<NChan>> frng(W);
+    disiple::RunningMax  <Scalar, Channels<NChan>> fmax(W);
+    disiple::RunningRange<Scalar, Channels<NChan>> frng(W);
 
     Array<Scalar, nchan, Dynamic> data = (ArrayXXf::Random(nchan, 97) * 10 + 20).cast<Scalar>();
     Array<Scalar, nchan, 1> ymin, ymax, yrng, zmin, zmax, zrng;
@@ -40,11 +43,287 @@ TEMPLATE_TEST_CASE_SIG("Running Min, Max and Range", "[running_stats]",
 
         // Calculate results using the filters
         fmin.apply(data.col(i), ymin);
-        // fmax.apply(data.col(i), ymax);
-        // frng.apply(data.col(i), yrng);
+        fmax.apply(data.col(i), ymax);
+        frng.apply(data.col(i), yrng);
 
         REQUIRE( (zmin - ymin).abs().maxCoeff() <= threshold<Scalar>() );
-        // REQUIRE( (zmax - ymax).abs().maxCoeff() <= threshold<Scalar>() );
-        // REQUIRE( (zrng - yrng).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (zmax - ymax).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (zrng - yrng).abs().maxCoeff() <= threshold<Scalar>() );
     }
 }
+
+TEST_CASE("Running Min and Max over long runs", "[running_stats]")
+{
+    const int W = 500, N = 20000;
+
+    // monotonic stretches make the wedges fill up to the window length
+    ArrayXXd data(2, N);
+    for (int i=0; i<N; ++i) {
+        data(0, i) = (i / 1000) % 2 ? -i : i;
+        data(1, i) = std::sin(i * 0.001) + 0.01 * (i % 7);
+    }
+
+    RunningMin  <double, Channels<2>> fmin(W);
+    RunningMax  <double, Channels<2>> fmax(W);
+    RunningRange<double, Channels<2>> frng(W);
+    ArrayXXd ymin(2, N), ymax(2, N), yrng(2, N);
+
+    // split into blocks, the state carries over
+    fmin.apply(data.leftCols(777), ymin.leftCols(777));
+    fmin.apply(data.rightCols(N-777), ymin.rightCols(N-777));
+    fmax.apply(data, ymax);
+    frng.apply(data, yrng);
+
+    for (int i=0; i<N; i+=37)
+    {
+        const int b = std::max(0, i-W+1);
+        auto block = data.middleCols(b, i-b+1);
+        REQUIRE( (ymin.col(i) - block.rowwise().minCoeff()).abs().maxCoeff() == 0 );
+        REQUIRE( (ymax.col(i) - block.rowwise().maxCoeff()).abs().maxCoeff() == 0 );
+        REQUIRE( (yrng.col(i) - (ymax.col(i) - ymin.col(i))).abs().maxCoeff() == 0 );
+    }
+
+    REQUIRE_THROWS_AS( RunningMin<double>(0), std::invalid_argument );
+}
+
+TEMPLATE_TEST_CASE_SIG("Block Running Min, Max and Range", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (int, Dynamic), (double, nchan)
+) {
+    const int N = 97;
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    Array<Scalar, NChan, Dynamic> ymin(nchan, N), ymax(nchan, N), yrng(nchan, N);
+    Array<Scalar, NChan, Dynamic> zmin(nchan, N), zmax(nchan, N), zrng(nchan, N);
+
+    for (int W : { 1, 2, 10, 32, N-1, N, 200 })
+    {
+        RunningMin  <Scalar, Channels<NChan>> fmin(W);
+        RunningMax  <Scalar, Channels<NChan>> fmax(W);
+        RunningRange<Scalar, Channels<NChan>> frng(W);
+        fmin.apply(data, zmin);
+        fmax.apply(data, zmax);
+        frng.apply(data, zrng);
+
+        running_min(data, W, ymin);
+        running_max(data, W, ymax);
+        running_range(data, W, yrng);
+
+        REQUIRE( (ymin - zmin).abs().maxCoeff() == 0 );
+        REQUIRE( (ymax - zmax).abs().maxCoeff() == 0 );
+        REQUIRE( (yrng - zrng).abs().maxCoeff() == 0 );
+
+        // in-place
+        Array<Scalar, NChan, Dynamic> inplace = data;
+        running_range(inplace, W, inplace);
+        REQUIRE( (inplace - zrng).abs().maxCoeff() == 0 );
+    }
+
+    REQUIRE_THROWS_AS( running_min(data, 0, ymin), std::invalid_argument );
+    REQUIRE_THROWS_AS( running_max(data, 5, ymax.leftCols(10)), std::invalid_argument );
+}
+
+namespace {
+
+    // numpy.quantile's default, linear interpolation
+    double reference_quantile(std::vector<double> v, double q)
+    {
+        std::sort(v.begin(), v.end());
+        const double p = q * (v.size()-1);
+        const size_t i = size_t(std::floor(p));
+        return i+1 < v.size() ? v[i] + (p-i) * (v[i+1] - v[i]) : v[i];
+    }
+
+}
+
+TEMPLATE_TEST_CASE_SIG("Running Median and Quantile", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, Dynamic), (int, Dynamic),
+    (float, nchan),   (double, nchan)
+) {
+    const int N = 300;
+
+    // few distinct values make for many ties
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    Array<Scalar, NChan, Dynamic> y(nchan, N);
+
+    for (int W : { 1, 2, 7, 10, 64 })
+    for (double q : { 0.0, 0.1, 0.25, 0.5, 0.9, 1.0 })
+    {
+        RunningQuantile<Scalar, Channels<NChan>> f(W, q);
+        f.apply(data.leftCols(100), y.leftCols(100));
+        f.apply(data.rightCols(N-100), y.rightCols(N-100));
+
+        for (int i=0; i<N; ++i)
+        for (int c=0; c<int(nchan); ++c)
+        {
+            std::vector<double> window;
+            for (int j = std::max(0, i-W+1); j <= i; ++j)
+                window.push_back(double(data(c, j)));
+
+            const Scalar z = static_cast<Scalar>(reference_quantile(window, q));
+            REQUIRE( std::abs(double(y(c, i) - z)) <= 10 * threshold<Scalar>() );
+        }
+    }
+
+    // the median is the 0.5 quantile
+    RunningMedian  <Scalar, Channels<NChan>> fmed(10);
+    RunningQuantile<Scalar, Channels<NChan>> fq(10, 0.5);
+    Array<Scalar, NChan, Dynamic> z(nchan, N);
+    fmed.apply(data, y);
+    fq.apply(data, z);
+    REQUIRE( (y - z).abs().maxCoeff() == 0 );
+
+    REQUIRE_THROWS_AS( (RunningQuantile<Scalar>(10, 1.5)), std::invalid_argument );
+    REQUIRE_THROWS_AS( (RunningMedian<Scalar>(0)), std::invalid_argument );
+}
+
+TEMPLATE_TEST_CASE_SIG("Running Variance, Std and Z-Score", "[running_stats]",
+    ((typename Scalar, int NChan, int Len), Scalar, NChan, Len),
+    (float, Dynamic, Dynamic), (double, Dynamic, Dynamic),
+    (float, nchan, 10), (double, nchan, Dynamic)
+) {
+    const int W = 10, N = 5000;
+
+    // a large offset makes naive sums of squares useless in float
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXd::Random(nchan, N) * 10 + 1000).cast<Scalar>();
+    Array<Scalar, NChan, Dynamic> yvar(nchan, N), ystd(nchan, N), yz(nchan, N);
+
+    RunningVariance<Scalar, Length<Len>, Channels<NChan>> fvar(W);
+    RunningStd     <Scalar, Length<Len>, Channels<NChan>> fstd(W);
+    RunningZScore  <Scalar, Length<Len>, Channels<NChan>> fz(W);
+    fvar.apply(data, yvar);
+    fstd.apply(data.leftCols(77), ystd.leftCols(77));
+    fstd.apply(data.rightCols(N-77), ystd.rightCols(N-77));
+    fz.apply(data, yz);
+
+    const double tol = std::is_same<Scalar, float>::value ? 1e-2 : 1e-9;
+
+    for (int i=0; i<N; ++i)
+    {
+        const int b = std::max(0, i-W+1);
+        const ArrayXXd block = data.middleCols(b, i-b+1).template cast<double>();
+        const ArrayXd mean = block.rowwise().mean();
+        const ArrayXd var  = (block.colwise() - mean).square().rowwise().mean();
+        const ArrayXd sd   = var.sqrt();
+        const ArrayXd z    = (sd > 0).select((data.col(i).template cast<double>() - mean) / sd, 0);
+
+        REQUIRE( (yvar.col(i).template cast<double>() - var).abs().maxCoeff() <= tol * 10 );
+        REQUIRE( (ystd.col(i).template cast<double>() - sd).abs().maxCoeff() <= tol );
+        REQUIRE( (yz.col(i).template cast<double>() - z).abs().maxCoeff() <= tol );
+    }
+
+    REQUIRE_THROWS_AS( RunningVariance<Scalar>(0), std::invalid_argument );
+
+    // default constructed with dynamic length: a window of one sample
+    RunningStd   <Scalar, Channels<NChan>> dstd;
+    RunningZScore<Scalar, Channels<NChan>> dz;
+    dstd.apply(data, ystd);
+    dz.apply(data, yz);
+    REQUIRE( (ystd == 0).all() );
+    REQUIRE( (yz == 0).all() );
+}
+
+TEST_CASE("Running Std and Z-Score of a flat float window", "[running_stats]")
+{
+    const int W = 10, N = 300;
+
+    for (float level : { 100000.1f, 1000.123f, -2.5f, 0.0f })
+    {
+        // noise, then a constant segment whose mean rounds a few ulps off
+        ArrayXXf data(1, N);
+        data.leftCols(N/2)  = ArrayXXf::Random(1, N/2) * 10 + level;
+        data.rightCols(N/2) = level;
+
+        RunningStd   <float> fstd(W);
+        RunningZScore<float> fz(W);
+        ArrayXXf ystd(1, N), yz(1, N);
+        fstd.apply(data, ystd);
+        fz.apply(data, yz);
+
+        REQUIRE( (ystd.rightCols(N/2-W+1) == 0).all() );
+        REQUIRE( (yz.rightCols(N/2-W+1) == 0).all() );
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG("Running ArgMin and ArgMax", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (int, Dynamic), (double, nchan)
+) {
+    const int W = 10, N = 97;
+
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    Array<Scalar, NChan, Dynamic> ymin(nchan, N), ymax(nchan, N);
+
+    RunningArgMin<Scalar, Channels<NChan>> fmin(W);
+    RunningArgMax<Scalar, Channels<NChan>> fmax(W);
+
+    for (int i=0; i<N; ++i)
+    {
+        fmin.apply(data.col(i), ymin.col(i));
+        fmax.apply(data.col(i), ymax.col(i));
+
+        for (int c=0; c<int(nchan); ++c)
+        {
+            // the most recent extremum of the window
+            int jmin = i, jmax = i;
+            for (int j = i; j >= std::max(0, i-W+1); --j) {
+                if (data(c, j) < data(c, jmin)) jmin = j;
+                if (data(c, j) > data(c, jmax)) jmax = j;
+            }
+
+            REQUIRE( ymin(c, i) == Scalar(i - jmin) );
+            REQUIRE( ymax(c, i) == Scalar(i - jmax) );
+            REQUIRE( fmin.index(c) == jmin );
+            REQUIRE( fmax.value(c) == data(c, jmax) );
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG("Histogram Quantiles", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, nchan), (int, Dynamic)
+) {
+    const int N = 20000, bins = 200;
+    const double lower = 0, upper = 40, width = (upper - lower) / bins;
+
+    // some samples fall outside the bins
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 25 + 20).cast<Scalar>();
+
+    Histogram<Scalar, Channels<NChan>> whole(lower, upper, bins), a(lower, upper, bins), b(lower, upper, bins);
+    whole.apply(data);
+
+    // blocks on different "threads", merged
+    a.apply(data.leftCols(5000));
+    b.apply(data.middleCols(5000, 8000));
+    b.apply(data.rightCols(N-13000));
+    a.merge(b);
+
+    REQUIRE( (a.counts() - whole.counts()).abs().maxCoeff() == 0 );
+    REQUIRE( (a.count() == N).all() );
+    REQUIRE( (whole.counts().colwise().sum().transpose() == N).all() );
+    REQUIRE( (whole.min() == data.rowwise().minCoeff().template cast<double>()).all() );
+    REQUIRE( (whole.max() == data.rowwise().maxCoeff().template cast<double>()).all() );
+
+    for (double q : { 0.0, 0.01, 0.25, 0.5, 0.9, 1.0 })
+    {
+        const auto h = whole.quantile(q);
+        REQUIRE( (a.quantile(q) - h).abs().maxCoeff() == 0 );
+
+        for (int c = 0; c < int(nchan); ++c)
+        {
+            std::vector<double> v(N);
+            for (int i = 0; i < N; ++i)
+                v[i] = double(data(c, i));
+            const double z = reference_quantile(v, q);
+
+            // exact at the extremes, within a bin width inside the bins,
+            // an integer's width where int samples pile up on one value
+            const double tol = (q == 0 || q == 1) ? 0 : std::is_same<Scalar, int>::value ? 1.0 : width;
+            REQUIRE( std::abs(h[c] - z) <= tol );
+        }
+    }
+
+    Histogram<Scalar, Channels<NChan>> other(lower, upper, bins + 1);
+    REQUIRE_THROWS_AS( a.merge(other), std::invalid_argument );
+    REQUIRE_THROWS_AS( (Histogram<Scalar>(1, 1, 10)), std::invalid_argument );
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/sliding_dft.hpp>
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+using namespace Eigen;
+using namespace disiple;
+
+static const int nchan = 3;
+static const int ndata = 1000;
+
+namespace {
+    template <typename Scalar> Scalar threshold();
+    template <> float  threshold<float>()  { return 1e-3f; }
+    template <> double threshold<double>() { return 1e-9; }
+}
+
+TEMPLATE_TEST_CASE_SIG("Sliding DFT", "[sliding_dft]",
+    ((typename Scalar, int NChan, bool DynLength), Scalar, NChan, DynLength),
+    (float,  Dynamic, true),  (double, Dynamic, true),
+    (float,  nchan,   false), (double, nchan,   false)
+) {
+    enum { N = 250 };
+    using Filter = SlidingDFT<Scalar, Length<DynLength ? Dynamic : N>, Channels<NChan>>;
+
+    // 250 Hz sampling: 50 Hz mains with amplitude 3 and its
+    // first harmonic with amplitude 1, on top of a DC offset
+    Array<Scalar, Dynamic, Dynamic> x(nchan, ndata), y(2*nchan, ndata);
+    for (int t = 0; t < ndata; ++t)
+        for (int c = 0; c < nchan; ++c)
+            x(c, t) = Scalar(3 * std::cos(0.4 * M_PI * t + c) + std::sin(0.8 * M_PI * t) + 10 * c);
+
+    SECTION("amplitudes", "Amplitudes of tracked frequencies") {
+        Filter f(N, { 0.4, 0.8 });
+        f.apply(x, y);
+
+        REQUIRE( f.num_bins() == 2 );
+        REQUIRE( (f.amplitudes().col(0) - 3).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (f.amplitudes().col(1) - 1).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (y.topRows(nchan).rightCols(ndata-N) - 3).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( (y.bottomRows(nchan).rightCols(ndata-N) - 1).abs().maxCoeff() <= threshold<Scalar>() );
+
+        Array<Scalar, Dynamic, Dynamic> wrong(nchan, ndata);
+        REQUIRE_THROWS_AS( f.apply(x, wrong), std::invalid_argument );
+    }
+
+    SECTION("direct_dft", "Every bin matches the direct dft at every hop") {
+        const std::vector<double> w = { 0.0, 0.123, 0.4, 1.0 };
+        const int hop = 7, nbins = int(w.size());
+        Filter f(N, w, hop);
+        Array<Scalar, Dynamic, Dynamic> z(nbins*nchan, 600);
+        f.apply(x.leftCols(600), z);
+
+        for (int t = hop-1; t < 600; t += hop)
+            for (int k = 0; k < nbins; ++k)
+                for (int c = 0; c < nchan; ++c) {
+                    std::complex<double> s = 0;
+                    for (int m = std::max(0, t-N+1); m <= t; ++m)
+                        s += double(x(c, m)) * std::polar(1.0, -w[k] * M_PI * m);
+                    const double edge = w[k] == 0.0 || w[k] == 1.0 ? 1 : 2;
+                    REQUIRE( std::abs(z(k*nchan+c, t) - edge * std::abs(s) / N)
+                             <= threshold<Scalar>() * 10 * (1 + 10 * c) );
+                }
+    }
+
+    SECTION("hop", "Amplitudes are updated every hop samples") {
+        Filter f(N, { 0.4, 0.8 }), g(N, { 0.4, 0.8 }, 10);
+        Array<Scalar, Dynamic, Dynamic> z(2*nchan, ndata);
+        f.apply(x, y);
+        g.apply(x, z);
+
+        // held since the last update, at t = 9, 19, 29, ...
+        REQUIRE( z.leftCols(9).abs().maxCoeff() == 0 );
+        for (int t = 9; t < ndata; ++t)
+            REQUIRE( (z.col(t) - y.col((t+1) / 10 * 10 - 1)).abs().maxCoeff() == 0 );
+    }
+
+    SECTION("update_only", "Sliding DFT state updated without applying it") {
+        Filter f(N, { 0.4, 0.8 }), g(N, { 0.4, 0.8 });
+        f.apply(x, y);
+        g.apply(x.leftCols(500), dry_run);
+        Array<Scalar, Dynamic, Dynamic> z(2*nchan, ndata-500);
+        g.apply(x.rightCols(ndata-500), z);
+        REQUIRE( (z - y.rightCols(ndata-500)).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+
+    SECTION("damped", "Damped sliding DFT keeps its scaling") {
+        Filter f(N, { 0.4 }, 1, 0.999);
+        f.apply(x, y.topRows(nchan));
+        REQUIRE( (f.amplitudes().col(0) - 3).abs().maxCoeff() <= Scalar(0.05) );
+    }
+
+    SECTION("init_nonzero", "Sliding DFT initialized to steady state") {
+        Array<Scalar, Dynamic, 1> x0(nchan); x0 << 1, 2, 3;
+        Filter f(N, { 0.0, 0.4 });
+        f.initialize(x0);
+        REQUIRE( (f.amplitudes().col(0) - x0).abs().maxCoeff() <= threshold<Scalar>() );
+        REQUIRE( f.amplitudes().col(1).abs().maxCoeff() <= threshold<Scalar>() );
+    }
+}
+
+TEST_CASE("Default constructed sliding DFT", "[sliding_dft]")
+{
+    // no tracked frequencies, with a unit window length
+    SlidingDFT<double> f;
+    REQUIRE( f.length() == 1 );
+    REQUIRE( f.num_bins() == 0 );
+
+    ArrayXXd x = ArrayXXd::Random(1, 20), y(0, 20);
+    f.apply(x, y);
+    f.apply(x, dry_run);
+    REQUIRE( f.amplitudes().size() == 0 );
+}
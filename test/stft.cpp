@@ -0,0 +1,71 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/stft.hpp>
+#include <vector>
+
+using namespace Eigen;
+using namespace disiple;
+
+TEST_CASE("STFT of streamed multichannel data", "[stft]")
+{
+    const int nchan = 4, ndata = 1000, len = 64, hop = 24;
+
+    STFT stft(hann(len/2, len-1-len/2), hop);
+    REQUIRE( stft.length() == len );
+    REQUIRE( stft.num_bins() == len/2+1 );
+
+    ArrayXXf x = ArrayXXf::Random(nchan, ndata);
+
+    // reference: window and transform every frame directly
+    const int nframes = 1 + (ndata - len) / hop;
+    FFT fft(len);
+    std::vector<ArrayXXcf> ref;
+    for (int k = 0; k < nframes; ++k) {
+        ArrayXXf frame = x.middleCols(k*hop, len);
+        frame.rowwise() *= stft.window().transpose();
+        ArrayXXcf spec(nchan, len/2+1);
+        fft.batch(frame, spec);
+        ref.push_back(spec);
+    }
+
+    SECTION("in blocks of varying size")
+    {
+        std::vector<ArrayXXcf> frames;
+        int t = 0, block = 1;
+        while (t < ndata) {
+            const int n = std::min(block, ndata - t);
+            const int expected = stft.frames_ready(n);
+            REQUIRE( stft.apply(x.middleCols(t, n),
+                                [&](const ArrayXXcf& f) { frames.push_back(f); }) == expected );
+            t += n;
+            block = block * 3 % 97;
+        }
+
+        REQUIRE( int(frames.size()) == nframes );
+        for (int k = 0; k < nframes; ++k)
+            REQUIRE( (frames[k] - ref[k]).abs().maxCoeff() <= 1e-5f );
+    }
+
+    SECTION("into preallocated output")
+    {
+        ArrayXXcf y(nchan, nframes * stft.num_bins());
+        REQUIRE( stft.apply(x, y) == nframes );
+        for (int k = 0; k < nframes; ++k)
+            REQUIRE( (y.middleCols(k*stft.num_bins(), stft.num_bins()) - ref[k]).abs().maxCoeff() <= 1e-5f );
+
+        ArrayXXcf too_small(nchan, stft.num_bins());
+        stft.initialize();
+        REQUIRE_THROWS_AS( stft.apply(x, too_small), std::invalid_argument );
+    }
+
+    SECTION("into preallocated output after a change of channel count")
+    {
+        // leave the mono buffer one sample short of a frame, then switch to
+        // nchan channels: the buffer restarts and no frame is ready yet
+        ArrayXXf mono = ArrayXXf::Random(1, len-1);
+        REQUIRE( stft.apply(mono, [](const ArrayXXcf&) {}) == 0 );
+
+        ArrayXXcf too_small(nchan, 0);
+        REQUIRE( stft.apply(x.leftCols(1), too_small) == 0 );
+        REQUIRE_THROWS_AS( stft.apply(x.middleCols(1, len), too_small), std::invalid_argument );
+    }
+}
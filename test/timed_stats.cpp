@@ -0,0 +1,77 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/timed_statistics.hpp>
+#include <disiple/running_statistics.hpp>
+#include <disiple/moving_average.hpp>
+#include <cmath>
+
+using namespace Eigen;
+using namespace disiple;
+
+static const size_t nchan = 4;
+
+TEMPLATE_TEST_CASE_SIG("Timed Running Min, Max and Mean", "[running_stats]",
+    ((typename Scalar, int NChan), Scalar, NChan),
+    (float, Dynamic), (double, Dynamic), (int, Dynamic), (double, nchan)
+) {
+    const int N = 1000;
+    const double horizon = 0.5;
+
+    // jittered 100 Hz with a few dropouts, and a burst of identical times
+    ArrayXd t(N);
+    double now = 0;
+    for (int i=0; i<N; ++i) {
+        now += (i % 97 == 0) ? 1.3 : (i >= 500 && i < 520) ? 0 : 0.01 * (1 + 0.5 * std::sin(i * 0.7));
+        t[i] = now;
+    }
+
+    Array<Scalar, NChan, Dynamic> data = (ArrayXXf::Random(nchan, N) * 10 + 20).cast<Scalar>();
+    Array<Scalar, NChan, Dynamic> ymin(nchan, N), ymax(nchan, N), ymean(nchan, N);
+
+    TimedRunningMin <Scalar, Channels<NChan>> fmin(horizon);
+    TimedRunningMax <Scalar, Channels<NChan>> fmax(horizon);
+    TimedRunningMean<Scalar, Channels<NChan>> fmean(horizon);
+
+    fmin.apply(data.leftCols(300), t.head(300), ymin.leftCols(300));
+    fmin.apply(data.rightCols(N-300), t.tail(N-300), ymin.rightCols(N-300));
+    fmax.apply(data, t, ymax);
+    fmean.apply(data, t, ymean);
+
+    for (int i=0; i<N; ++i)
+    {
+        int b = i;
+        while (b > 0 && t[b-1] > t[i] - horizon)
+            --b;
+        auto block = data.middleCols(b, i-b+1);
+
+        REQUIRE( (ymin.col(i) - block.rowwise().minCoeff()).abs().maxCoeff() == 0 );
+        REQUIRE( (ymax.col(i) - block.rowwise().maxCoeff()).abs().maxCoeff() == 0 );
+        const Array<Scalar, NChan, 1> mean = (block.template cast<double>().rowwise().sum() / (i-b+1)).template cast<Scalar>();
+        REQUIRE( (ymean.col(i) - mean).abs().maxCoeff() <= Scalar(1e-4) );
+    }
+
+    ArrayXd backwards = t.head(10).reverse();
+    REQUIRE_THROWS_AS( fmin.apply(data.leftCols(10), backwards, ymin.leftCols(10)), std::invalid_argument );
+    REQUIRE_THROWS_AS( fmax.apply(data.leftCols(10), t.head(9), ymax.leftCols(10)), std::invalid_argument );
+    REQUIRE_THROWS_AS( TimedRunningMean<Scalar>(0.0), std::invalid_argument );
+}
+
+TEST_CASE("Timed Running statistics on a uniform grid", "[running_stats]")
+{
+    // with equidistant samples, a horizon of W samples is a window of W samples
+    const int W = 10, N = 200;
+    ArrayXXd data = ArrayXXd::Random(nchan, N);
+    ArrayXd t = ArrayXd::LinSpaced(N, 0, N-1);
+    ArrayXXd y(nchan, N), z(nchan, N);
+
+    TimedRunningMax<double, Channels<Dynamic>> ftimed(W);
+    RunningMax<double, Channels<Dynamic>> fcount(W);
+    ftimed.apply(data, t, y);
+    fcount.apply(data, z);
+    REQUIRE( (y - z).abs().maxCoeff() == 0 );
+
+    TimedRunningMean<double, Channels<Dynamic>> fmean(W);
+    MovingAverage<double, Channels<Dynamic>> favg(W);
+    fmean.apply(data, t, y);
+    favg.apply(data, z);
+    REQUIRE( (y - z).abs().maxCoeff() <= 1e-12 );
+}
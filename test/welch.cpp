@@ -0,0 +1,109 @@
+#include <catch2/catch_all.hpp>
+#include <disiple/welch.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace Eigen;
+using namespace disiple;
+
+TEST_CASE("Welch PSD of white noise", "[welch]")
+{
+    const int nchan = 2, ndata = 20000, len = 128;
+
+    Welch welch(hann(len/2, len-1-len/2), len/2);
+
+    // uniform noise in [-1,1] has variance 1/3
+    ArrayXXf x = ArrayXXf::Random(nchan, ndata);
+    for (int t = 0; t < ndata; t += 1000)
+        welch.apply(x.middleCols(t, 1000));
+
+    REQUIRE( welch.num_segments() == 1 + (ndata - len) / (len/2) );
+    REQUIRE( welch.num_chans() == nchan );
+
+    // one-sided density, sampling rate 1: 2 * variance
+    const ArrayXXf& p = welch.psd();
+    for (int c = 0; c < nchan; ++c)
+        REQUIRE( std::abs(p.row(c).segment(1, len/2-1).mean() - 2.0f/3.0f) <= 0.05f * 2.0f/3.0f );
+
+    REQUIRE_THROWS_AS( welch.csd(0, 1), std::runtime_error );
+}
+
+TEST_CASE("Welch averaging is incremental", "[welch]")
+{
+    const int nchan = 3, ndata = 1000, len = 64, hop = 16;
+
+    ArrayXXf x = ArrayXXf::Random(nchan, ndata);
+
+    // reference: all periodograms of the stft
+    STFT stft(hamming(len/2, len-1-len/2), hop);
+    ArrayXXf sum = ArrayXXf::Zero(nchan, len/2+1), last;
+    std::vector<ArrayXXf> periodograms;
+    stft.apply(x, [&](const ArrayXXcf& f) { last = f.abs2(); sum += last; periodograms.push_back(last); });
+    const int nseg = 1 + (ndata - len) / hop;
+
+    SECTION("running")
+    {
+        Welch welch(hamming(len/2, len-1-len/2), hop);
+        for (int t = 0; t < ndata; t += 10)
+            welch.apply(x.middleCols(t, 10));
+
+        REQUIRE( welch.num_segments() == nseg );
+        // same up to the density scaling, which is constant for inner bins
+        ArrayXXf ratio = welch.psd().middleCols(1, len/2-1) / (sum / float(nseg)).middleCols(1, len/2-1);
+        REQUIRE( (ratio - ratio(0, 0)).abs().maxCoeff() <= 1e-4f * ratio(0, 0) );
+    }
+
+    SECTION("exponential")
+    {
+        Welch welch(hamming(len/2, len-1-len/2), hop, WelchAveraging::Exponential, 1.0);
+        welch.apply(x);
+
+        ArrayXXf ratio = welch.psd().middleCols(1, len/2-1) / last.middleCols(1, len/2-1);
+        REQUIRE( (ratio - ratio(0, 0)).abs().maxCoeff() <= 1e-4f * ratio(0, 0) );
+    }
+
+    SECTION("exponential, seeded by the first segments")
+    {
+        const double alpha = 0.25;
+        Welch welch(hamming(len/2, len-1-len/2), hop, WelchAveraging::Exponential, alpha);
+        const float scale = 2.0f / stft.window().square().sum();
+
+        // the first 1/alpha estimates are plain means, then new segments get weight alpha
+        ArrayXXf sum4 = ArrayXXf::Zero(nchan, len/2+1), expected;
+        for (int k = 0; k < 8; ++k) {
+            welch.apply(x.middleCols(k == 0 ? 0 : len + (k-1)*hop, k == 0 ? len : hop));
+            REQUIRE( welch.num_segments() == k+1 );
+
+            if (k < 4) {
+                sum4 += periodograms[k];
+                expected = sum4 / float(k+1);
+            }
+            else
+                expected += float(alpha) * (periodograms[k] - expected);
+
+            ArrayXXf ratio = welch.psd().middleCols(1, len/2-1) / expected.middleCols(1, len/2-1);
+            REQUIRE( (ratio - scale).abs().maxCoeff() <= 1e-4f * scale );
+        }
+    }
+}
+
+TEST_CASE("Welch cross spectra and coherence", "[welch]")
+{
+    const int ndata = 20000, len = 128;
+
+    Welch welch(hann(len/2, len-1-len/2), len/2, WelchAveraging::Running, 0.1, true);
+
+    // channel 1 follows channel 0 closely, channel 2 is independent
+    ArrayXXf x(3, ndata);
+    x.row(0).setRandom();
+    x.row(1) = x.row(0) + 0.1f * ArrayXXf::Random(1, ndata);
+    x.row(2).setRandom();
+    welch.apply(x);
+
+    // the cross spectral density of a channel with itself is its psd
+    REQUIRE( (welch.csd(1, 1).real() - welch.psd().row(1).transpose()).abs().maxCoeff() <= 1e-5f );
+    REQUIRE( (welch.csd(1, 0) - welch.csd(0, 1).conjugate()).abs().maxCoeff() == 0 );
+
+    REQUIRE( welch.coherence(0, 1).mean() > 0.95f );
+    REQUIRE( welch.coherence(0, 2).mean() < 0.1f );
+}